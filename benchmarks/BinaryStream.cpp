@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/BinaryStream.h>
+#include <spark/SafeBinaryStream.h>
+#include <spark/buffers/ChainedBuffer.h>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <cstdint>
+
+namespace spark = ember::spark;
+
+namespace {
+
+const int FIELDS = 64;
+
+template<typename Stream>
+void write_fields(Stream& stream) {
+	for(int i = 0; i < FIELDS; ++i) {
+		stream << std::uint8_t(1) << std::uint16_t(2) << std::uint32_t(3) << std::uint64_t(4);
+	}
+}
+
+template<typename Stream>
+void read_fields(Stream& stream) {
+	std::uint8_t u8;
+	std::uint16_t u16;
+	std::uint32_t u32;
+	std::uint64_t u64;
+
+	for(int i = 0; i < FIELDS; ++i) {
+		stream >> u8 >> u16 >> u32 >> u64;
+	}
+
+	benchmark::DoNotOptimize(u8 + u16 + u32 + u64);
+}
+
+} // unnamed
+
+template<typename Stream>
+static void stream_scalars(benchmark::State& state) {
+	spark::ChainedBuffer<1024> chain;
+	Stream stream(chain);
+
+	for(auto _ : state) {
+		write_fields(stream);
+		read_fields(stream);
+	}
+
+	state.SetItemsProcessed(state.iterations() * FIELDS * 4);
+}
+
+// type-erased streams dispatch every operation through spark::Buffer
+BENCHMARK_TEMPLATE(stream_scalars, spark::BinaryStream);
+BENCHMARK_TEMPLATE(stream_scalars, spark::SafeBinaryStream);
+BENCHMARK_TEMPLATE(stream_scalars, spark::BasicBinaryStream<spark::ChainedBuffer<1024>>);
+BENCHMARK_TEMPLATE(stream_scalars, spark::BasicSafeBinaryStream<spark::ChainedBuffer<1024>>);
+
+template<typename Stream>
+static void stream_strings(benchmark::State& state) {
+	spark::ChainedBuffer<1024> chain;
+	Stream stream(chain);
+	const std::string input(state.range(0), 'x');
+	std::string output;
+
+	for(auto _ : state) {
+		stream << input;
+		output.clear();
+		stream >> output;
+		benchmark::DoNotOptimize(output.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+BENCHMARK_TEMPLATE(stream_strings, spark::BinaryStream)->Range(8, 4 << 10);
+BENCHMARK_TEMPLATE(stream_strings, spark::SafeBinaryStream)->Range(8, 4 << 10);
+
+template<typename Stream>
+static void stream_bounded_strings(benchmark::State& state) {
+	spark::ChainedBuffer<1024> chain;
+	Stream stream(chain);
+	const std::string input(state.range(0), 'x');
+	std::string output;
+
+	for(auto _ : state) {
+		stream << input;
+		output.clear();
+		stream.get_string(output, input.size());
+		benchmark::DoNotOptimize(output.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+BENCHMARK_TEMPLATE(stream_bounded_strings, spark::BinaryStream)->Range(8, 4 << 10);
+BENCHMARK_TEMPLATE(stream_bounded_strings, spark::SafeBinaryStream)->Range(8, 4 << 10);
+
+template<typename Stream>
+static void stream_view(benchmark::State& state) {
+	spark::ChainedBuffer<1024> chain;
+	Stream stream(chain);
+	std::string input(state.range(0), 'x');
+
+	for(auto _ : state) {
+		stream.put(input.data(), input.size());
+		benchmark::DoNotOptimize(stream.view(input.size()));
+	}
+
+	state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+BENCHMARK_TEMPLATE(stream_view, spark::BinaryStream)->Range(8, 4 << 10);
+BENCHMARK_TEMPLATE(stream_view, spark::SafeBinaryStream)->Range(8, 4 << 10);
\ No newline at end of file
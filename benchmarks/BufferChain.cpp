@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/buffers/ChainedBuffer.h>
+#include <spark/buffers/ChainedCursor.h>
+#include <spark/buffers/BufferSequence.h>
+#include <benchmark/benchmark.h>
+#include <boost/asio/buffer.hpp>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace spark = ember::spark;
+
+template<std::size_t BlockSize>
+static void chain_write_read(benchmark::State& state) {
+	spark::ChainedBuffer<BlockSize> chain;
+	std::vector<char> data(state.range(0));
+
+	for(auto _ : state) {
+		chain.write(data.data(), data.size());
+		chain.read(data.data(), data.size());
+		benchmark::DoNotOptimize(data.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_TEMPLATE(chain_write_read, 64)->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(chain_write_read, 1024)->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(chain_write_read, 4096)->Range(8, 8 << 10);
+
+template<std::size_t BlockSize>
+static void chain_write_skip(benchmark::State& state) {
+	spark::ChainedBuffer<BlockSize> chain;
+	std::vector<char> data(state.range(0));
+
+	for(auto _ : state) {
+		chain.write(data.data(), data.size());
+		chain.skip(data.size());
+	}
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_TEMPLATE(chain_write_skip, 64)->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(chain_write_skip, 1024)->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(chain_write_skip, 4096)->Range(8, 8 << 10);
+
+// many small writes, as produced by streaming individual fields
+template<std::size_t BlockSize>
+static void chain_scalar_writes(benchmark::State& state) {
+	spark::ChainedBuffer<BlockSize> chain;
+	const std::uint32_t value = 0xBADF00D;
+
+	for(auto _ : state) {
+		for(int i = 0; i < 256; ++i) {
+			chain.write(&value, sizeof(value));
+		}
+
+		chain.skip(chain.size());
+	}
+
+	state.SetItemsProcessed(state.iterations() * 256);
+}
+
+BENCHMARK_TEMPLATE(chain_scalar_writes, 64);
+BENCHMARK_TEMPLATE(chain_scalar_writes, 1024);
+
+/*
+ * Sequential access through the whole chain via each of the available methods.
+ * operator[] walks from the head of the chain on every access.
+ */
+static void chain_subscript(benchmark::State& state) {
+	spark::ChainedBuffer<64> chain;
+	std::vector<char> data(state.range(0));
+	chain.write(data.data(), data.size());
+
+	for(auto _ : state) {
+		char sum = 0;
+
+		for(std::size_t i = 0; i < chain.size(); ++i) {
+			sum += chain[i];
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(chain_subscript)->Range(64, 4 << 10);
+
+static void chain_iterator(benchmark::State& state) {
+	spark::ChainedBuffer<64> chain;
+	std::vector<char> data(state.range(0));
+	chain.write(data.data(), data.size());
+
+	for(auto _ : state) {
+		char sum = 0;
+
+		for(auto it = chain.begin(); it != chain.end(); ++it) {
+			sum += *it;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(chain_iterator)->Range(64, 4 << 10);
+
+static void chain_cursor(benchmark::State& state) {
+	spark::ChainedBuffer<64> chain;
+	std::vector<char> data(state.range(0));
+	chain.write(data.data(), data.size());
+
+	for(auto _ : state) {
+		spark::ChainedCursor<64> cursor(chain);
+		char sum = 0;
+
+		for(std::size_t i = 0; i < chain.size(); ++i) {
+			sum += cursor[i];
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(chain_cursor)->Range(64, 4 << 10);
+
+// seeking to a single offset, as done when patching a packet header
+static void chain_iterator_seek(benchmark::State& state) {
+	spark::ChainedBuffer<64> chain;
+	std::vector<char> data(state.range(0));
+	chain.write(data.data(), data.size());
+
+	for(auto _ : state) {
+		auto it = chain.begin() + (data.size() - 1);
+		benchmark::DoNotOptimize(*it);
+	}
+}
+
+BENCHMARK(chain_iterator_seek)->Range(64, 4 << 10);
+
+static void chain_buffer_sequence(benchmark::State& state) {
+	spark::ChainedBuffer<64> chain;
+	std::vector<char> data(state.range(0));
+	chain.write(data.data(), data.size());
+	spark::BufferSequence<64> sequence(chain);
+
+	for(auto _ : state) {
+		std::size_t total = 0;
+
+		for(auto it = sequence.begin(); it != sequence.end(); ++it) {
+			total += boost::asio::buffer_size(*it);
+		}
+
+		benchmark::DoNotOptimize(total);
+	}
+}
+
+BENCHMARK(chain_buffer_sequence)->Range(64, 64 << 10);
+
+static void chain_fetch_segments(benchmark::State& state) {
+	spark::ChainedBuffer<64> chain;
+	std::vector<char> data(state.range(0));
+	chain.write(data.data(), data.size());
+
+	for(auto _ : state) {
+		std::size_t total = 0;
+
+		for(auto segment : chain.fetch_buffers(data.size() - 1, 1)) {
+			total += segment.size;
+		}
+
+		benchmark::DoNotOptimize(total);
+	}
+}
+
+BENCHMARK(chain_fetch_segments)->Range(64, 64 << 10);
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "Messages.h"
+#include <spark/Compression.h>
+#include <benchmark/benchmark.h>
+#include <flatbuffers/flatbuffers.h>
+#include <vector>
+#include <cstdint>
+
+namespace spark = ember::spark;
+using ember::benchmarks::build_character_list;
+
+// baseline, what goes on the wire without compression
+static void link_uncompressed(benchmark::State& state) {
+	flatbuffers::FlatBufferBuilder fbb;
+	build_character_list(fbb, state.range(0));
+	std::vector<std::uint8_t> wire;
+
+	for(auto _ : state) {
+		wire.assign(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+		benchmark::DoNotOptimize(wire.data());
+	}
+
+	state.counters["raw_bytes"] = fbb.GetSize();
+	state.counters["wire_bytes"] = fbb.GetSize();
+}
+
+BENCHMARK(link_uncompressed)->Arg(1)->Arg(10);
+
+/*
+ * Each iteration sends the same message over a long-lived stream, as repeated
+ * requests for a character list would be. wire_bytes is the average size
+ * of the deflated messages.
+ */
+static void link_deflate(benchmark::State& state) {
+	flatbuffers::FlatBufferBuilder fbb;
+	build_character_list(fbb, state.range(0));
+	spark::DeflateStream deflater(state.range(1));
+	std::vector<std::uint8_t> wire;
+	std::size_t total = 0;
+
+	for(auto _ : state) {
+		wire.clear();
+		deflater.deflate(fbb.GetBufferPointer(), fbb.GetSize(), wire);
+		total += wire.size();
+	}
+
+	state.counters["raw_bytes"] = fbb.GetSize();
+	state.counters["wire_bytes"] = static_cast<double>(total) / state.iterations();
+}
+
+BENCHMARK(link_deflate)->ArgNames({ "characters", "level" })
+	->Args({ 1, 1 })->Args({ 10, 1 })->Args({ 1, 6 })->Args({ 10, 6 })->Args({ 10, 9 });
+
+static void link_round_trip(benchmark::State& state) {
+	flatbuffers::FlatBufferBuilder fbb;
+	build_character_list(fbb, state.range(0));
+	spark::DeflateStream deflater(state.range(1));
+	spark::InflateStream inflater;
+	std::vector<std::uint8_t> wire;
+	std::vector<std::uint8_t> output(fbb.GetSize());
+	std::size_t total = 0;
+
+	for(auto _ : state) {
+		wire.clear();
+		deflater.deflate(fbb.GetBufferPointer(), fbb.GetSize(), wire);
+		inflater.inflate(wire.data(), wire.size(), output.data(), output.size());
+		total += wire.size();
+	}
+
+	state.counters["raw_bytes"] = fbb.GetSize();
+	state.counters["wire_bytes"] = static_cast<double>(total) / state.iterations();
+}
+
+BENCHMARK(link_round_trip)->ArgNames({ "characters", "level" })
+	->Args({ 1, 1 })->Args({ 10, 1 })->Args({ 1, 6 })->Args({ 10, 6 });
+
+// a fresh stream per message, as if the streams weren't kept per session
+static void link_deflate_unshared(benchmark::State& state) {
+	flatbuffers::FlatBufferBuilder fbb;
+	build_character_list(fbb, state.range(0));
+	std::vector<std::uint8_t> wire;
+	std::size_t total = 0;
+
+	for(auto _ : state) {
+		spark::DeflateStream deflater(state.range(1));
+		wire.clear();
+		deflater.deflate(fbb.GetBufferPointer(), fbb.GetSize(), wire);
+		total += wire.size();
+	}
+
+	state.counters["raw_bytes"] = fbb.GetSize();
+	state.counters["wire_bytes"] = static_cast<double>(total) / state.iterations();
+}
+
+BENCHMARK(link_deflate_unshared)->ArgNames({ "characters", "level" })->Args({ 1, 6 })->Args({ 10, 6 });
\ No newline at end of file
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <spark/temp/MessageRoot_generated.h>
+#include <flatbuffers/flatbuffers.h>
+#include <string>
+#include <vector>
+
+namespace ember { namespace benchmarks {
+
+// a character list reply, the largest message regularly sent over a link
+inline void build_character_list(flatbuffers::FlatBufferBuilder& fbb, int count) {
+	std::vector<flatbuffers::Offset<messaging::character::Character>> characters;
+
+	for(int i = 0; i < count; ++i) {
+		auto name = fbb.CreateString("Character" + std::to_string(i));
+		messaging::character::CharacterBuilder cbb(fbb);
+		cbb.add_id(i);
+		cbb.add_account_id(1);
+		cbb.add_realm_id(1);
+		cbb.add_name(name);
+		cbb.add_race(1);
+		cbb.add_class_(1);
+		cbb.add_level(60);
+		cbb.add_zone(1519);
+		cbb.add_map(0);
+		cbb.add_x(-8949.95f);
+		cbb.add_y(-132.493f);
+		cbb.add_z(83.5312f);
+		characters.push_back(cbb.Finish());
+	}
+
+	auto vector = fbb.CreateVector(characters);
+	messaging::character::RetrieveResponseBuilder rrb(fbb);
+	rrb.add_status(messaging::character::Status::OK);
+	rrb.add_characters(vector);
+	auto data = rrb.Finish();
+
+	messaging::MessageRootBuilder mrb(fbb);
+	mrb.add_service(messaging::Service::Character);
+	mrb.add_data_type(messaging::Data::RetrieveResponse);
+	mrb.add_data(data.Union());
+	fbb.Finish(mrb.Finish());
+}
+
+}} // benchmarks, ember
\ No newline at end of file
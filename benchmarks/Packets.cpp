@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <game_protocol/Packets.h>
+#include <login/grunt/Exceptions.h>
+#include <login/grunt/server/RealmList.h>
+#include <spark/buffers/ChainedBuffer.h>
+#include <spark/BinaryStream.h>
+#include <spark/SafeBinaryStream.h>
+#include <benchmark/benchmark.h>
+#include <boost/endian/arithmetic.hpp>
+#include <boost/endian/conversion.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <zlib.h>
+
+namespace spark = ember::spark;
+namespace protocol = ember::protocol;
+namespace grunt = ember::grunt;
+
+static void smsg_char_enum(benchmark::State& state) {
+	protocol::SMSG_CHAR_ENUM packet;
+
+	for(int i = 0; i < state.range(0); ++i) {
+		ember::Character character{};
+		character.name = "Character" + std::to_string(i);
+		character.id = i;
+		character.level = 60;
+		packet.characters.emplace_back(character);
+	}
+
+	spark::ChainedBuffer<4096> chain;
+	spark::SafeBinaryStream stream(chain);
+
+	for(auto _ : state) {
+		packet.write_to_stream(stream);
+		protocol::SMSG_CHAR_ENUM output;
+		output.read_from_stream(stream);
+		benchmark::DoNotOptimize(output.characters.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(smsg_char_enum)->Arg(1)->Arg(10);
+
+// the type-erased stream against one over the concrete buffer, as the gateway sends it
+template<typename StreamType>
+static void smsg_char_enum_write(benchmark::State& state) {
+	protocol::SMSG_CHAR_ENUM packet;
+
+	for(int i = 0; i < state.range(0); ++i) {
+		ember::Character character{};
+		character.name = "Character" + std::to_string(i);
+		character.id = i;
+		character.level = 60;
+		packet.characters.emplace_back(character);
+	}
+
+	spark::ChainedBuffer<4096> chain;
+	StreamType stream(chain);
+
+	for(auto _ : state) {
+		stream << packet;
+		chain.skip(chain.size());
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(smsg_char_enum_write, spark::SafeBinaryStream)->Arg(1)->Arg(10);
+BENCHMARK_TEMPLATE(smsg_char_enum_write, spark::BasicSafeBinaryStream<spark::ChainedBuffer<4096>>)->Arg(1)->Arg(10);
+
+static void cmsg_auth_session(benchmark::State& state) {
+	protocol::CMSG_AUTH_SESSION packet;
+	packet.build = 5875;
+	packet.username = "TESTACCOUNT";
+	packet.digest.resize(20);
+
+	// the packet doesn't serialise addon data, so it's appended manually
+	std::vector<std::uint8_t> addons;
+
+	for(int i = 0; i < state.range(0); ++i) {
+		const std::string name("Blizzard_Addon" + std::to_string(i));
+		addons.insert(addons.end(), name.c_str(), name.c_str() + name.size() + 1);
+		addons.insert(addons.end(), 9, 0); // key version, CRC, update URL CRC
+	}
+
+	std::vector<std::uint8_t> compressed(compressBound(static_cast<uLong>(addons.size())));
+	uLongf compressed_size = static_cast<uLongf>(compressed.size());
+	compress(compressed.data(), &compressed_size, addons.data(), static_cast<uLong>(addons.size()));
+
+	spark::ChainedBuffer<4096> chain;
+	spark::SafeBinaryStream stream(chain);
+
+	for(auto _ : state) {
+		packet.write_to_stream(stream);
+		stream << boost::endian::native_to_little(static_cast<std::uint32_t>(addons.size()));
+		stream.put(compressed.data(), compressed_size);
+
+		protocol::CMSG_AUTH_SESSION output;
+		output.set_size(static_cast<std::uint16_t>(stream.size()));
+		output.read_from_stream(stream);
+		benchmark::DoNotOptimize(output.addons.data());
+	}
+}
+
+BENCHMARK(cmsg_auth_session)->Arg(1)->Arg(20);
+
+static void grunt_realm_list(benchmark::State& state) {
+	grunt::server::RealmList packet;
+
+	for(int i = 0; i < state.range(0); ++i) {
+		ember::Realm realm{};
+		realm.id = i;
+		realm.name = "Realm" + std::to_string(i);
+		realm.ip = "127.0.0.1:8085";
+		packet.realms.push_back({ realm, 0 });
+	}
+
+	spark::ChainedBuffer<1024> chain;
+	spark::BinaryStream stream(chain);
+	spark::SafeBinaryStream safe_stream(chain);
+
+	for(auto _ : state) {
+		packet.write_to_stream(stream);
+		grunt::server::RealmList output;
+		output.read_from_stream(safe_stream);
+		benchmark::DoNotOptimize(output.realms.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(grunt_realm_list)->Arg(1)->Arg(50);
\ No newline at end of file
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/SharedChannel.h>
+#include <benchmark/benchmark.h>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace spark = ember::spark;
+namespace ba = boost::asio;
+
+/*
+ * Round trip latency of a length-prefixed message between two threads, over
+ * each of the transports available to peers on the same host. Both ends
+ * sleep while waiting rather than spinning, as a link does.
+ */
+namespace {
+
+template<typename Socket>
+void echo(Socket& socket) {
+	std::vector<std::uint8_t> buffer;
+	std::uint32_t length;
+	boost::system::error_code ec;
+
+	while(ba::read(socket, ba::buffer(&length, sizeof(length)), ec), !ec) {
+		buffer.resize(length);
+		ba::read(socket, ba::buffer(buffer), ec);
+		ba::write(socket, std::vector<ba::const_buffer> {
+			ba::buffer(&length, sizeof(length)), ba::buffer(buffer)
+		}, ec);
+	}
+}
+
+template<typename Socket>
+void socket_round_trip(benchmark::State& state, Socket& client, Socket& server) {
+	std::thread echo_thread([&]() { echo(server); });
+	std::vector<std::uint8_t> message(state.range(0));
+	auto length = static_cast<std::uint32_t>(message.size());
+
+	for(auto _ : state) {
+		ba::write(client, std::vector<ba::const_buffer> {
+			ba::buffer(&length, sizeof(length)), ba::buffer(message)
+		});
+
+		ba::read(client, ba::buffer(&length, sizeof(length)));
+		ba::read(client, ba::buffer(message));
+	}
+
+	client.shutdown(ba::socket_base::shutdown_both);
+	echo_thread.join();
+}
+
+// blocks until the ring has a message, as a session would
+void wait(ba::io_service& service, spark::SharedChannel& channel) {
+	auto& ring = channel.inbound();
+
+	while(ring.empty()) {
+		if(!ring.consumer_wait()) {
+			break;
+		}
+
+		channel.async_wait([](boost::system::error_code) { });
+		service.run_one();
+		service.reset();
+	}
+}
+
+void send(spark::SharedChannel& channel, const void* data, std::size_t size) {
+	channel.outbound().write(data, size);
+
+	if(channel.outbound().wake_consumer()) {
+		channel.notify();
+	}
+}
+
+} // unnamed
+
+static void tcp_round_trip(benchmark::State& state) {
+	ba::io_service service;
+	ba::ip::tcp::acceptor acceptor(service, ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+	ba::ip::tcp::socket client(service), server(service);
+	client.connect(acceptor.local_endpoint());
+	acceptor.accept(server);
+	client.set_option(ba::ip::tcp::no_delay(true));
+	server.set_option(ba::ip::tcp::no_delay(true));
+	socket_round_trip(state, client, server);
+}
+
+BENCHMARK(tcp_round_trip)->Arg(64)->Arg(1024)->Arg(16 << 10)->UseRealTime();
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+static void local_round_trip(benchmark::State& state) {
+	ba::io_service service;
+	ba::local::stream_protocol::socket client(service), server(service);
+	ba::local::connect_pair(client, server);
+	socket_round_trip(state, client, server);
+}
+
+BENCHMARK(local_round_trip)->Arg(64)->Arg(1024)->Arg(16 << 10)->UseRealTime();
+
+static void shared_memory_round_trip(benchmark::State& state) {
+	ba::io_service client_service, server_service;
+	ba::local::stream_protocol::socket client_socket(client_service), server_socket(server_service);
+	ba::local::connect_pair(client_socket, server_socket);
+
+	auto client = spark::SharedChannel::create(client_service);
+	std::unique_ptr<spark::SharedChannel> server;
+
+	if(!client || !spark::SharedChannel::send_handshake(client_socket.native_handle(), client.get())
+	   || !spark::SharedChannel::receive_handshake(server_service, server_socket.native_handle(), server)) {
+		state.SkipWithError("Shared memory is unavailable");
+		return;
+	}
+
+	std::atomic_bool stop { false };
+
+	std::thread echo_thread([&]() {
+		const std::uint8_t* data;
+		std::size_t size;
+
+		while(!stop) {
+			wait(server_service, *server);
+
+			while(server->inbound().peek(data, size)) {
+				send(*server, data, size);
+				server->inbound().pop(size);
+			}
+		}
+	});
+
+	std::vector<std::uint8_t> message(state.range(0));
+	const std::uint8_t* data;
+	std::size_t size;
+
+	for(auto _ : state) {
+		send(*client, message.data(), message.size());
+		wait(client_service, *client);
+		client->inbound().peek(data, size);
+		benchmark::DoNotOptimize(data);
+		client->inbound().pop(size);
+	}
+
+	stop = true;
+	send(*client, message.data(), 0);
+	echo_thread.join();
+}
+
+BENCHMARK(shared_memory_round_trip)->Arg(64)->Arg(1024)->Arg(16 << 10)->UseRealTime();
+
+#endif
\ No newline at end of file
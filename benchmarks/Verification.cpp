@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "Messages.h"
+#include <spark/MessageHandler.h>
+#include <benchmark/benchmark.h>
+#include <flatbuffers/flatbuffers.h>
+
+namespace spark = ember::spark;
+using ember::benchmarks::build_character_list;
+
+/*
+ * Cost of checking an inbound character list before it's dispatched, on an
+ * untrusted link (full verification) and a trusted one (root bounds only).
+ */
+static void verify_message(benchmark::State& state) {
+	flatbuffers::FlatBufferBuilder fbb;
+	build_character_list(fbb, state.range(0));
+	const bool trusted = state.range(1) != 0;
+
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(spark::MessageHandler::verify(fbb.GetBufferPointer(), fbb.GetSize(), trusted));
+	}
+
+	state.SetBytesProcessed(state.iterations() * fbb.GetSize());
+}
+
+BENCHMARK(verify_message)->ArgNames({ "characters", "trusted" })
+	->Args({ 1, 0 })->Args({ 1, 1 })->Args({ 10, 0 })->Args({ 10, 1 })->Args({ 50, 0 })->Args({ 50, 1 });
\ No newline at end of file
@@ -89,7 +89,7 @@ void Service::send_register_reply(const spark::Link& link, const em::MessageRoot
                                   em::account::Status status) {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	em::account::ResponseBuilder rb(*fbb);
 	rb.add_status(status);
 	auto data_offset = rb.Finish();
@@ -102,14 +102,14 @@ void Service::send_register_reply(const spark::Link& link, const em::MessageRoot
 	auto mloc = mrb.Finish();
 
 	fbb->Finish(mloc);
-	spark_.send(link, fbb);
+	spark_.send_batched(link, fbb);
 }
 
 void Service::send_account_locate_reply(const spark::Link& link, const em::MessageRoot* root) {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
 	auto msg = static_cast<const em::account::AccountLookup*>(root->data());
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 
 	em::account::AccountLookupResponseBuilder klb(*fbb);
 	klb.add_status(em::account::Status::OK);
@@ -124,7 +124,7 @@ void Service::send_account_locate_reply(const spark::Link& link, const em::Messa
 	auto mloc = mrb.Finish();
 
 	fbb->Finish(mloc);
-	spark_.send(link, fbb);
+	spark_.send_batched(link, fbb);
 
 	// todo, logging
 }
@@ -135,7 +135,7 @@ void Service::send_locate_reply(const spark::Link& link, const em::MessageRoot*
 
 	auto msg = static_cast<const em::account::KeyLookup*>(root->data());
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	em::account::KeyLookupRespBuilder klb(*fbb);
 	em::account::Status status;
 
@@ -159,7 +159,7 @@ void Service::send_locate_reply(const spark::Link& link, const em::MessageRoot*
 	auto mloc = mrb.Finish();
 
 	fbb->Finish(mloc);
-	spark_.send(link, fbb);
+	spark_.send_batched(link, fbb);
 
 	LOG_DEBUG(logger_) << "Session key lookup: " << msg->account_id() << " -> "
 		<< util::fb_status(status, messaging::account::EnumNamesStatus()) << LOG_ASYNC;
@@ -76,12 +76,27 @@ void launch(const po::variables_map& args, el::Logger* logger) try {
 	auto mcast_group = args["spark.multicast_group"].as<std::string>();
 	auto mcast_iface = args["spark.multicast_interface"].as<std::string>();
 	auto mcast_port = args["spark.multicast_port"].as<std::uint16_t>();
+	auto local_socket = args["spark.local_socket"].as<std::string>();
+	auto trust = args["spark.trust"].as<std::string>();
+	auto batch_window = args["spark.batch_window"].as<unsigned int>();
+	auto batch_limit = args["spark.batch_limit"].as<unsigned int>();
+	auto flush_messages = args["spark.flush_messages"].as<unsigned int>();
+	auto flush_bytes = args["spark.flush_bytes"].as<unsigned int>();
 	auto spark_filter = el::Filter(ember::FilterType::LF_SPARK);
 
 	es::Service spark("account", service, s_address, s_port, logger, spark_filter);
 	es::ServiceDiscovery discovery(service, s_address, s_port, mcast_iface, mcast_group,
 	                               mcast_port, logger, spark_filter);
 
+	spark.trust(es::trust_string(trust));
+	spark.batching(std::chrono::microseconds(batch_window), batch_limit);
+	spark.flush_limits({ flush_messages, flush_bytes });
+
+	if(!local_socket.empty()) {
+		spark.listen_local(local_socket);
+		discovery.announce_local(local_socket);
+	}
+
 	ember::Sessions sessions(true);
 	ember::Service net_service(sessions, spark, discovery, logger);
 
@@ -117,6 +132,12 @@ po::variables_map parse_arguments(int argc, const char* argv[]) {
 		("spark.multicast_interface,", po::value<std::string>()->required())
 		("spark.multicast_group", po::value<std::string>()->required())
 		("spark.multicast_port", po::value<std::uint16_t>()->required())
+		("spark.local_socket", po::value<std::string>()->default_value(""))
+		("spark.trust", po::value<std::string>()->default_value("none"))
+		("spark.batch_window", po::value<unsigned int>()->default_value(500))
+		("spark.batch_limit", po::value<unsigned int>()->default_value(64))
+		("spark.flush_messages", po::value<unsigned int>()->default_value(32))
+		("spark.flush_bytes", po::value<unsigned int>()->default_value(65536))
 		("console_log.verbosity", po::value<std::string>()->required())
 		("console_log.filter-mask", po::value<std::uint32_t>()->default_value(0))
 		("console_log.colours", po::bool_switch()->required())
@@ -95,7 +95,7 @@ void Service::send_character_list(const spark::Link& link, const std::vector<std
                                   const boost::optional<std::vector<Character>>& characters) {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	em::character::RetrieveResponseBuilder rrb(*fbb);
 
 	// painful
@@ -158,7 +158,7 @@ void Service::send_rename_response(const spark::Link& link, const std::vector<st
 								   boost::optional<Character> character) {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	em::character::RenameResponseBuilder rb(*fbb);
 	rb.add_status(status);
 	rb.add_result(static_cast<std::uint32_t>(result));
@@ -190,7 +190,7 @@ void Service::send_response(const spark::Link& link, const std::vector<std::uint
 							messaging::character::Status status, protocol::Result result) {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	em::character::CharResponseBuilder rb(*fbb);
 	rb.add_status(status);
 	rb.add_result(static_cast<std::uint32_t>(result));
@@ -141,6 +141,10 @@ void launch(const po::variables_map& args, log::Logger* logger) try {
 	auto mcast_group = args["spark.multicast_group"].as<std::string>();
 	auto mcast_iface = args["spark.multicast_interface"].as<std::string>();
 	auto mcast_port = args["spark.multicast_port"].as<std::uint16_t>();
+	auto local_socket = args["spark.local_socket"].as<std::string>();
+	auto trust = args["spark.trust"].as<std::string>();
+	auto flush_messages = args["spark.flush_messages"].as<unsigned int>();
+	auto flush_bytes = args["spark.flush_bytes"].as<unsigned int>();
 	auto spark_filter = log::Filter(ember::FilterType::LF_SPARK);
 
 	boost::asio::io_service service;
@@ -154,6 +158,14 @@ void launch(const po::variables_map& args, log::Logger* logger) try {
 	spark::ServiceDiscovery discovery(service, s_address, s_port, mcast_iface, mcast_group,
 	                               mcast_port, logger, spark_filter);
 
+	spark.trust(spark::trust_string(trust));
+	spark.flush_limits({ flush_messages, flush_bytes });
+
+	if(!local_socket.empty()) {
+		spark.listen_local(local_socket);
+		discovery.announce_local(local_socket);
+	}
+
 	ember::Service char_service(*character_dao, handler, spark, discovery, logger);
 	
 	signals.async_wait([&](const boost::system::error_code& error, int signal) {
@@ -193,6 +205,10 @@ po::variables_map parse_arguments(int argc, const char* argv[]) {
 		("spark.multicast_interface", po::value<std::string>()->required())
 		("spark.multicast_group", po::value<std::string>()->required())
 		("spark.multicast_port", po::value<std::uint16_t>()->required())
+		("spark.local_socket", po::value<std::string>()->default_value(""))
+		("spark.trust", po::value<std::string>()->default_value("none"))
+		("spark.flush_messages", po::value<unsigned int>()->default_value(32))
+		("spark.flush_bytes", po::value<unsigned int>()->default_value(65536))
 		("console_log.verbosity", po::value<std::string>()->required())
 		("console_log.filter-mask", po::value<std::uint32_t>()->default_value(0))
 		("console_log.colours", po::value<bool>()->required())
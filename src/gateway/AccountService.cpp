@@ -8,11 +8,22 @@
 
 #include "AccountService.h"
 #include <boost/uuid/uuid.hpp>
+#include <chrono>
+#include <functional>
 
 namespace em = ember::messaging;
 
 namespace ember {
 
+namespace {
+
+// two attempts, hedged after the 95th percentile of recent lookups or 20ms, or retried on failure
+const spark::RequestPolicy LOOKUP_POLICY {
+	2, true, true, 0.95, std::chrono::milliseconds(20), std::chrono::seconds(2)
+};
+
+} // unnamed
+
 AccountService::AccountService(spark::Service& spark, spark::ServiceDiscovery& s_disc, log::Logger* logger)
                                : spark_(spark), s_disc_(s_disc), logger_(logger) {
 	spark_.dispatcher()->register_handler(this, em::Service::Account, spark::EventDispatcher::Mode::CLIENT);
@@ -35,11 +46,10 @@ void AccountService::handle_link_event(const spark::Link& link, spark::LinkState
 
 	switch(event) {
 		case spark::LinkState::LINK_UP:
-			LOG_INFO(logger_) << "Link to account server established" << LOG_ASYNC;
-			link_ = link;
+			LOG_INFO(logger_) << "Link to account server established: " << link.description << LOG_ASYNC;
 			break;
 		case spark::LinkState::LINK_DOWN:
-			LOG_INFO(logger_) << "Link to account server closed" << LOG_ASYNC;
+			LOG_INFO(logger_) << "Link to account server closed: " << link.description << LOG_ASYNC;
 			break;
 	}
 }
@@ -47,7 +57,7 @@ void AccountService::handle_link_event(const spark::Link& link, spark::LinkState
 void AccountService::service_located(const messaging::multicast::LocateAnswer* message) {
 	LOG_DEBUG(logger_) << "Located account service at " << message->ip()->str() 
 	                   << ":" << message->port() << LOG_ASYNC;
-	spark_.connect(message->ip()->str(), message->port());
+	spark_.connect(message);
 }
 
 void AccountService::handle_register_reply(const spark::Link& link, const boost::uuids::uuid& uuid,
@@ -100,20 +110,29 @@ void AccountService::handle_id_locate_reply(const spark::Link& link, const boost
 	cb(em::account::Status::OK, account_id); // temp
 }
 
+/*
+ * Lookups are idempotent, so they're hedged to a second account server if the
+ * first is slow to answer, rather than holding the client up until it times out.
+ * An account's lookups go to the same server while it's up, to keep its session
+ * cache useful.
+ */
 void AccountService::locate_session(const std::uint32_t account_id, SessionLocateCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
-	auto uuid = generate_uuid();
-	auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
-	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Account, uuid_bytes, 0,
-		em::Data::KeyLookup, em::account::CreateKeyLookup(*fbb, account_id).Union());
-	fbb->Finish(msg);
+	auto builder = [account_id](const boost::uuids::uuid& uuid) {
+		auto fbb = spark::BuilderPool::acquire();
+		auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
+		auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Account, uuid_bytes, 0,
+			em::Data::KeyLookup, em::account::CreateKeyLookup(*fbb, account_id).Union());
+		fbb->Finish(msg);
+		return fbb;
+	};
 
 	auto track_cb = std::bind(&AccountService::handle_locate_reply, this, std::placeholders::_1,
 	                          std::placeholders::_2, std::placeholders::_3, cb);
 
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+	if(spark_.send_hedged(em::Service::Account, account_id, builder, track_cb, LOOKUP_POLICY)
+	   != spark::Service::Result::OK) {
 		cb(em::account::Status::SERVER_LINK_ERROR, 0);
 	}
 }
@@ -121,17 +140,20 @@ void AccountService::locate_session(const std::uint32_t account_id, SessionLocat
 void AccountService::locate_account_id(const std::string& username, IDLocateCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
-	auto uuid = generate_uuid();
-	auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
-	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Account, uuid_bytes, 0,
-		em::Data::AccountLookup, em::account::CreateAccountLookup(*fbb, fbb->CreateString(username)).Union());
-	fbb->Finish(msg);
+	auto builder = [username](const boost::uuids::uuid& uuid) {
+		auto fbb = spark::BuilderPool::acquire();
+		auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
+		auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Account, uuid_bytes, 0,
+			em::Data::AccountLookup, em::account::CreateAccountLookup(*fbb, fbb->CreateString(username)).Union());
+		fbb->Finish(msg);
+		return fbb;
+	};
 
 	auto track_cb = std::bind(&AccountService::handle_id_locate_reply, this, std::placeholders::_1,
 	                          std::placeholders::_2, std::placeholders::_3, cb);
 
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+	if(spark_.send_hedged(em::Service::Account, spark::routing_key(username), builder, track_cb,
+	                      LOOKUP_POLICY) != spark::Service::Result::OK) {
 		cb(em::account::Status::SERVER_LINK_ERROR, 0);
 	}
 }
@@ -13,7 +13,7 @@
 #include <spark/temp/MessageRoot_generated.h>
 #include <logger/Logging.h>
 #include <botan/bigint.h>
-#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid.hpp>
 #include <functional>
 #include <memory>
 #include <cstdint>
@@ -31,8 +31,6 @@ private:
 	spark::ServiceDiscovery& s_disc_;
 	log::Logger* logger_;
 	std::unique_ptr<spark::ServiceListener> listener_;
-	mutable boost::uuids::random_generator generate_uuid; // functor
-	spark::Link link_;
 	
 	void service_located(const messaging::multicast::LocateAnswer* message);
 
@@ -35,11 +35,10 @@ void CharacterService::handle_link_event(const spark::Link& link, spark::LinkSta
 
 	switch(event) {
 		case spark::LinkState::LINK_UP:
-			LOG_INFO(logger_) << "Link to character server established" << LOG_ASYNC;
-			link_ = link;
+			LOG_INFO(logger_) << "Link to character server established: " << link.description << LOG_ASYNC;
 			break;
 		case spark::LinkState::LINK_DOWN:
-			LOG_INFO(logger_) << "Link to character server closed" << LOG_ASYNC;
+			LOG_INFO(logger_) << "Link to character server closed: " << link.description << LOG_ASYNC;
 			break;
 	}
 }
@@ -47,7 +46,7 @@ void CharacterService::handle_link_event(const spark::Link& link, spark::LinkSta
 void CharacterService::service_located(const messaging::multicast::LocateAnswer* message) {
 	LOG_DEBUG(logger_) << "Located account service at " << message->ip()->str() 
 	                   << ":" << message->port() << LOG_ASYNC;
-	spark_.connect(message->ip()->str(), message->port());
+	spark_.connect(message);
 }
 
 void CharacterService::handle_reply(const spark::Link& link, const boost::uuids::uuid& uuid,
@@ -137,7 +136,7 @@ void CharacterService::create_character(std::uint32_t account_id, const Characte
                                         ResponseCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	
 	em::character::CharacterTemplateBuilder cbb(*fbb);
 	cbb.add_name(fbb->CreateString(character.name));
@@ -160,7 +159,10 @@ void CharacterService::create_character(std::uint32_t account_id, const Characte
 	auto track_cb = std::bind(&CharacterService::handle_reply, this, std::placeholders::_1,
 							  std::placeholders::_2, std::placeholders::_3, cb);
 
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+	// an account's characters are always handled by the same server while it's up
+	auto link = spark_.route(em::Service::Character, account_id);
+
+	if(!link || spark_.send_tracked(*link, uuid, fbb, track_cb) != spark::Service::Result::OK) {
 		cb(em::character::Status::SERVER_LINK_ERROR, {});
 	}
 }
@@ -169,7 +171,7 @@ void CharacterService::rename_character(std::uint32_t account_id, std::uint64_t
                                         const std::string& name, RenameCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 
 	auto uuid = generate_uuid();
 	auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
@@ -181,14 +183,16 @@ void CharacterService::rename_character(std::uint32_t account_id, std::uint64_t
 	auto track_cb = std::bind(&CharacterService::handle_rename_reply, this, std::placeholders::_1,
 	                          std::placeholders::_2, std::placeholders::_3, cb);
 
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+	auto link = spark_.route(em::Service::Character, account_id);
+
+	if(!link || spark_.send_tracked(*link, uuid, fbb, track_cb) != spark::Service::Result::OK) {
 		cb(em::character::Status::SERVER_LINK_ERROR, protocol::Result::CHAR_NAME_FAILURE, 0, nullptr);
 	}
 }
 void CharacterService::retrieve_characters(std::uint32_t account_id, RetrieveCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	auto uuid = generate_uuid();
 	auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
 	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Character, uuid_bytes, 0,
@@ -198,7 +202,9 @@ void CharacterService::retrieve_characters(std::uint32_t account_id, RetrieveCB
 	auto track_cb = std::bind(&CharacterService::handle_retrieve_reply, this, std::placeholders::_1,
 	                          std::placeholders::_2, std::placeholders::_3, cb);
 
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+	auto link = spark_.route(em::Service::Character, account_id);
+
+	if(!link || spark_.send_tracked(*link, uuid, fbb, track_cb) != spark::Service::Result::OK) {
 		std::vector<Character> chars;
 		cb(em::character::Status::SERVER_LINK_ERROR, chars);
 	}
@@ -207,7 +213,7 @@ void CharacterService::retrieve_characters(std::uint32_t account_id, RetrieveCB
 void CharacterService::delete_character(std::uint32_t account_id, std::uint64_t id, ResponseCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	auto uuid = generate_uuid();
 	auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
 	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Character, uuid_bytes, 0,
@@ -217,7 +223,9 @@ void CharacterService::delete_character(std::uint32_t account_id, std::uint64_t
 	auto track_cb = std::bind(&CharacterService::handle_reply, this, std::placeholders::_1,
 	                          std::placeholders::_2, std::placeholders::_3, cb);
 
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+	auto link = spark_.route(em::Service::Character, account_id);
+
+	if(!link || spark_.send_tracked(*link, uuid, fbb, track_cb) != spark::Service::Result::OK) {
 		cb(em::character::Status::SERVER_LINK_ERROR, {});
 	}
 }
@@ -36,7 +36,6 @@ private:
 	log::Logger* logger_;
 	std::unique_ptr<spark::ServiceListener> listener_;
 	mutable boost::uuids::random_generator generate_uuid; // functor
-	spark::Link link_;
 	const Config& config_;
 	
 	void service_located(const messaging::multicast::LocateAnswer* message);
@@ -9,7 +9,9 @@
 #include "ClientConnection.h"
 #include "SessionManager.h"
 #include <spark/buffers/BufferSequence.h>
+#include <spark/buffers/MutableBufferSequence.h>
 #include <zlib.h>
+#include <cstring>
 
 namespace ember {
 
@@ -25,10 +27,10 @@ void ClientConnection::parse_header(spark::Buffer& buffer) {
 	}
 
 	if(authenticated_) {
-		crypto_.decrypt(buffer, header_wire_size);
+		crypto_.decrypt(inbound_buffer_.begin(), header_wire_size);
 	}
 
-	spark::SafeBinaryStream stream(inbound_buffer_);
+	spark::BasicSafeBinaryStream<spark::ChainedBuffer<INBOUND_SIZE>> stream(inbound_buffer_);
 	stream >> packet_header_.size >> packet_header_.opcode;
 
 	LOG_TRACE_FILTER(logger_, LF_NETWORK) << remote_address() << " -> "
@@ -70,26 +72,52 @@ void ClientConnection::send(const protocol::ServerPacket& packet) {
 	LOG_TRACE_FILTER(logger_, LF_NETWORK) << remote_address() << " <- "
 		<< protocol::to_string(packet.opcode) << LOG_ASYNC;
 
-	spark::Buffer& buffer(*outbound_back_);
-	spark::SafeBinaryStream stream(buffer);
-	const std::size_t write_index = buffer.size(); // the current write index
+	spark::BasicSafeBinaryStream<spark::ChainedBuffer<OUTBOUND_SIZE>> stream(*outbound_back_);
+	const std::size_t write_index = stream.size(); // the current write index
 
 	stream << std::uint16_t(0) << packet.opcode << packet;
+	queue_chained(write_index);
+}
 
+// finalises a packet that was streamed into the outbound chain, starting at write_index
+void ClientConnection::queue_chained(std::size_t write_index) {
 	// calculate the size of the packet that we just streamed and then update the buffer
 	const boost::endian::big_uint16_at final_size =
-		static_cast<std::uint16_t>(stream.size() - write_index) - sizeof(protocol::ServerHeader::size);
+		static_cast<std::uint16_t>(outbound_back_->size() - write_index) - sizeof(protocol::ServerHeader::size);
+
+	// seek to the header once rather than indexing each byte from the head of the chain
+	auto header = outbound_back_->begin() + write_index;
+	auto it = header;
+	*it = final_size.data()[0];
+	*++it = final_size.data()[1];
+
+	if(authenticated_) {
+		constexpr std::size_t header_wire_size =
+			sizeof(protocol::ServerHeader::opcode) + sizeof(protocol::ServerHeader::size);
+		crypto_.encrypt(header, header_wire_size);
+	}
+
+	start_write();
+}
+
+// finalises a packet that was serialised into contiguous storage and appends it in a single copy
+void ClientConnection::queue_contiguous(char* data, std::size_t length) {
+	const boost::endian::big_uint16_at final_size =
+		static_cast<std::uint16_t>(length - sizeof(protocol::ServerHeader::size));
 
-	// todo, implement an iterator for the buffer at some point
-	buffer[write_index + 0] = final_size.data()[0];
-	buffer[write_index + 1] = final_size.data()[1];
+	std::memcpy(data, final_size.data(), sizeof(final_size));
 
 	if(authenticated_) {
 		constexpr std::size_t header_wire_size =
 			sizeof(protocol::ServerHeader::opcode) + sizeof(protocol::ServerHeader::size);
-		crypto_.encrypt(buffer, write_index, header_wire_size);
+		crypto_.encrypt(data, header_wire_size);
 	}
 
+	outbound_back_->write(data, length);
+	start_write();
+}
+
+void ClientConnection::start_write() {
 	if(!write_in_progress_) {
 		write_in_progress_ = true;
 		swap_buffers();
@@ -137,22 +165,24 @@ void ClientConnection::read() {
 		return;
 	}
 
-	auto tail = inbound_buffer_.back();
+	/*
+	 * Bursts of packets are received into multiple blocks at once so they need
+	 * fewer calls, but idle connections only hold a single block while waiting.
+	 */
+	inbound_buffer_.prepare(inbound_blocks_);
+	spark::MutableBufferSequence<INBOUND_SIZE> sequence(inbound_buffer_);
+	const auto capacity = boost::asio::buffer_size(sequence);
 
-	// if the buffer chain has no more space left, allocate & attach new node
-	if(!tail->free()) {
-		tail = inbound_buffer_.allocate();
-		inbound_buffer_.push_back(tail);
-	}
-
-	socket_.async_receive(boost::asio::buffer(tail->write_data(), tail->free()),
+	socket_.async_receive(sequence,
 		create_alloc_handler(allocator_,
-		[this](boost::system::error_code ec, std::size_t size) {
+		[this, capacity](boost::system::error_code ec, std::size_t size) {
+			inbound_buffer_.commit(size);
+			inbound_blocks_ = size == capacity? INBOUND_BLOCKS : 1;
+
 			if(!ec) {
 				stats_.bytes_in += size;
 				++stats_.packets_in;
 
-				inbound_buffer_.advance_write_cursor(size);
 				process_buffered_data(inbound_buffer_);
 				read();
 			} else if(ec != boost::asio::error::operation_aborted) {
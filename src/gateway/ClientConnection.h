@@ -12,8 +12,11 @@
 #include "ConnectionStats.h"
 #include "PacketCrypto.h"
 #include "FilterTypes.h"
+#include <game_protocol/Packet.h>
 #include <game_protocol/PacketHeaders.h> // todo, remove
 #include <spark/buffers/ChainedBuffer.h>
+#include <spark/buffers/StaticBuffer.h>
+#include <spark/SafeBinaryStream.h>
 #include <logger/Logging.h>
 #include <shared/ClientUUID.h>
 #include <shared/memory/ASIOAllocator.h>
@@ -26,6 +29,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <type_traits>
 #include <cstdint>
 
 namespace ember {
@@ -34,6 +38,7 @@ class SessionManager;
 
 class ClientConnection final {
 	static constexpr std::size_t INBOUND_SIZE = 1024;
+	static constexpr std::size_t INBOUND_BLOCKS = 4; // blocks per scatter read during bursts
 	static constexpr std::size_t OUTBOUND_SIZE = 2048;
 
 	enum class ReadState { HEADER, BODY, DONE } read_state_;
@@ -42,6 +47,7 @@ class ClientConnection final {
 	boost::asio::ip::tcp::socket socket_;
 
 	spark::ChainedBuffer<INBOUND_SIZE> inbound_buffer_;
+	std::size_t inbound_blocks_; // to prepare for the next read
 	std::array<spark::ChainedBuffer<OUTBOUND_SIZE>, 2> outbound_buffers_;
 	spark::ChainedBuffer<OUTBOUND_SIZE>* outbound_front_;
 	spark::ChainedBuffer<OUTBOUND_SIZE>* outbound_back_;
@@ -76,12 +82,15 @@ class ClientConnection final {
 	void completion_check(spark::Buffer& buffer);
 	void stream_compress(const protocol::ServerPacket& packet);
 	void swap_buffers();
+	void queue_contiguous(char* data, std::size_t length);
+	void queue_chained(std::size_t write_index);
+	void start_write();
 
 public:
 	ClientConnection(SessionManager& sessions, boost::asio::ip::tcp::socket socket,
 	                 ClientUUID uuid, log::Logger* logger)
 	                 : service_(socket.get_io_service()), sessions_(sessions),
-	                   socket_(std::move(socket)), stats_{}, crypto_{}, packet_header_{},
+	                   socket_(std::move(socket)), inbound_blocks_(1), stats_{}, crypto_{}, packet_header_{},
 	                   logger_(logger), read_state_(ReadState::HEADER), stopped_(true),
 	                   authenticated_(false), write_in_progress_(false),
 	                   address_(boost::lexical_cast<std::string>(socket_.remote_endpoint())),
@@ -100,6 +109,33 @@ public:
 
 	// these should be made private, only for use by the handler
 	void send(const protocol::ServerPacket& packet);
+
+	// packets that declare an upper bound on their size are serialised on the stack
+	template<typename PacketT, typename = decltype(PacketT::MAX_WIRE_LENGTH)>
+	void send(const PacketT& packet) {
+		LOG_TRACE_FILTER(logger_, LF_NETWORK) << remote_address() << " <- "
+			<< protocol::to_string(packet.opcode) << LOG_ASYNC;
+
+		spark::StaticBuffer<sizeof(protocol::ServerHeader::size) + sizeof(protocol::ServerHeader::opcode)
+		                    + PacketT::MAX_WIRE_LENGTH> buffer;
+		spark::BasicSafeBinaryStream<decltype(buffer)> stream(buffer);
+		stream << std::uint16_t(0) << packet.opcode << packet;
+		queue_contiguous(buffer.data(), buffer.size());
+	}
+
+	// packets with a templated body are streamed into the chain without type erasure
+	template<typename PacketT>
+	std::enable_if_t<protocol::has_write_body<PacketT>::value && !protocol::has_max_wire_length<PacketT>::value>
+	send(const PacketT& packet) {
+		LOG_TRACE_FILTER(logger_, LF_NETWORK) << remote_address() << " <- "
+			<< protocol::to_string(packet.opcode) << LOG_ASYNC;
+
+		spark::BasicSafeBinaryStream<spark::ChainedBuffer<OUTBOUND_SIZE>> stream(*outbound_back_);
+		const std::size_t write_index = stream.size();
+		stream << std::uint16_t(0) << packet.opcode << packet;
+		queue_chained(write_index);
+	}
+
 	void close_session();
 	void terminate();
 
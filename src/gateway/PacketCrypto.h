@@ -8,7 +8,6 @@
 
 #pragma once
 
-#include <spark/Buffer.h>
 #include <botan/bigint.h>
 #include <array>
 #include <cstdint>
@@ -29,20 +28,23 @@ public:
 		key_ = std::move(key);
 	}
 
-	void encrypt(spark::Buffer& data, std::size_t offset, std::size_t length) {
-		for(std::size_t t = 0; t < length; ++t) {
+	// takes any byte iterator, so chained buffers can be walked without per-byte seeks
+	template<typename Iterator>
+	void encrypt(Iterator data, std::size_t length) {
+		for(std::size_t t = 0; t < length; ++t, ++data) {
 			send_i_ %= key_.size();
-			char& byte = data[offset + t]; // todo - type change
+			char& byte = *data; // todo - type change
 			std::uint8_t x = (byte ^ key_[send_i_]) + send_j_;
 			++send_i_;
 			byte = send_j_ = x;
 		}
 	}
 
-	void decrypt(spark::Buffer& data, std::size_t length) {
-		for(std::size_t t = 0; t < length; ++t) {
+	template<typename Iterator>
+	void decrypt(Iterator data, std::size_t length) {
+		for(std::size_t t = 0; t < length; ++t, ++data) {
 			recv_i_ %= key_.size();
-			char& byte = data[t]; // todo - type change
+			char& byte = *data; // todo - type change
 			std::uint8_t x = (byte - recv_j_) ^ key_[recv_i_];
 			++recv_i_;
 			recv_j_ = byte;
@@ -161,15 +161,34 @@ void launch(const po::variables_map& args, log::Logger* logger) try {
 	auto mcast_group = args["spark.multicast_group"].as<std::string>();
 	auto mcast_iface = args["spark.multicast_interface"].as<std::string>();
 	auto mcast_port = args["spark.multicast_port"].as<std::uint16_t>();
+	auto local_socket = args["spark.local_socket"].as<std::string>();
+	auto trust = args["spark.trust"].as<std::string>();
+	auto link_stripes = args["spark.link_stripes"].as<unsigned int>();
+	auto shared_memory = args["spark.shared_memory"].as<bool>();
+	auto batch_window = args["spark.batch_window"].as<unsigned int>();
+	auto batch_limit = args["spark.batch_limit"].as<unsigned int>();
+	auto flush_messages = args["spark.flush_messages"].as<unsigned int>();
+	auto flush_bytes = args["spark.flush_bytes"].as<unsigned int>();
 	auto spark_filter = log::Filter(FilterType::LF_SPARK);
 
 	auto& service = service_pool.get_service();
 	boost::asio::signal_set signals(service, SIGINT, SIGTERM);
 
 	spark::Service spark("gateway-" + realm->name, service, s_address, s_port, logger, spark_filter);
+	spark.link_stripes(link_stripes, spark::ServicesMap::Balancing::LEAST_OUTSTANDING);
+	spark.shared_memory(shared_memory);
+	spark.batching(std::chrono::microseconds(batch_window), batch_limit);
+	spark.flush_limits({ flush_messages, flush_bytes });
 	spark::ServiceDiscovery discovery(service, s_address, s_port, mcast_iface, mcast_group,
 	                               mcast_port, logger, spark_filter);
 
+	spark.trust(spark::trust_string(trust));
+
+	if(!local_socket.empty()) {
+		spark.listen_local(local_socket);
+		discovery.announce_local(local_socket);
+	}
+
 	RealmQueue queue_service(service_pool.get_service());
 	RealmService realm_svc(*realm, spark, discovery, logger);
 	AccountService acct_svc(spark, discovery, logger);
@@ -247,6 +266,14 @@ po::variables_map parse_arguments(int argc, const char* argv[]) {
 		("spark.multicast_interface", po::value<std::string>()->required())
 		("spark.multicast_group", po::value<std::string>()->required())
 		("spark.multicast_port", po::value<std::uint16_t>()->required())
+		("spark.link_stripes", po::value<unsigned int>()->default_value(1))
+		("spark.local_socket", po::value<std::string>()->default_value(""))
+		("spark.trust", po::value<std::string>()->default_value("none"))
+		("spark.shared_memory", po::value<bool>()->default_value(false))
+		("spark.batch_window", po::value<unsigned int>()->default_value(500))
+		("spark.batch_limit", po::value<unsigned int>()->default_value(64))
+		("spark.flush_messages", po::value<unsigned int>()->default_value(32))
+		("spark.flush_bytes", po::value<unsigned int>()->default_value(65536))
 		("network.interface", po::value<std::string>()->required())
 		("network.port", po::value<std::uint16_t>()->required())
 		("network.tcp_no_delay", po::value<bool>()->required())
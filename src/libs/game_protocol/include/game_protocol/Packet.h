@@ -10,6 +10,8 @@
 
 #include <game_protocol/Opcodes.h>
 #include <spark/SafeBinaryStream.h>
+#include <type_traits>
+#include <utility>
 #include <cstdint>
 
 namespace ember { namespace protocol {
@@ -35,6 +37,40 @@ inline spark::SafeBinaryStream& operator<<(spark::SafeBinaryStream& out, const S
 	return out;
 }
 
+// adapts streams over concrete buffer types to the type-erased packet interface
+template<typename BufferType>
+inline spark::BasicSafeBinaryStream<BufferType>& operator<<(spark::BasicSafeBinaryStream<BufferType>& out,
+                                                            const ServerPacket& packet) {
+	spark::SafeBinaryStream stream(out.buffer());
+	packet.write_to_stream(stream);
+	return out;
+}
+
+/*
+ * Packets on hot paths also implement write_body, templated on the stream, with
+ * write_to_stream forwarding to it. Streams over concrete buffers then write each
+ * field directly, rather than through the type-erased stream and spark::Buffer.
+ */
+template<typename BufferType, typename PacketT>
+inline auto operator<<(spark::BasicSafeBinaryStream<BufferType>& out, const PacketT& packet)
+	-> decltype(packet.write_body(out), out) {
+	packet.write_body(out);
+	return out;
+}
+
+template<typename PacketT, typename = void>
+struct has_write_body : std::false_type { };
+
+template<typename PacketT>
+struct has_write_body<PacketT, decltype(std::declval<const PacketT&>()
+	.write_body(std::declval<spark::SafeBinaryStream&>()))> : std::true_type { };
+
+template<typename PacketT, typename = void>
+struct has_max_wire_length : std::false_type { };
+
+template<typename PacketT>
+struct has_max_wire_length<PacketT, decltype(void(PacketT::MAX_WIRE_LENGTH))> : std::true_type { };
+
 //inline spark::SafeBinaryStream& operator>>(spark::SafeBinaryStream& in, Packet& packet) {
 //	packet.read_from_stream(in); // todo, stream error states
 //	return in;
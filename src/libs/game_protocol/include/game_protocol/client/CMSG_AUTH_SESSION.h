@@ -31,6 +31,17 @@ class CMSG_AUTH_SESSION final : public Packet {
 	State state_ = State::INITIAL;
 	std::uint16_t size_ = 0;
 
+	// bytes of this message left in the stream - a bogus header may claim fewer than have been read
+	std::size_t remaining(std::size_t initial_stream_size, const spark::SafeBinaryStream& stream) const {
+		const auto consumed = initial_stream_size - stream.size();
+
+		if(consumed > size_) {
+			throw spark::buffer_underrun(consumed, size_);
+		}
+
+		return size_ - consumed;
+	}
+
 public:
 	struct AddonData {
 		std::string name;
@@ -56,7 +67,9 @@ public:
 
 		stream >> build;
 		stream >> unk1;
-		stream >> username;
+
+		// don't allow the username scan to run past the end of this message
+		stream.get_string(username, remaining(initial_stream_size, stream));
 		stream >> seed;
 
 		digest.resize(DIGEST_LENGTH);
@@ -68,21 +81,19 @@ public:
 
 		// calculate how much of the remaining stream data belongs to this message
 		// we don't want to consume bytes belongining to any messages that follow
-		auto remaining = size_ - (initial_stream_size - stream.size());
-		uLongf compressed_size = static_cast<uLongf>(remaining);
+		const auto compressed_size = static_cast<uLongf>(remaining(initial_stream_size, stream));
 
 		if(decompressed_size > 0xFFFFF) {
 			LOG_DEBUG_GLOB << "Rejecting compressed addon data for being too large "  << LOG_ASYNC;
 			return (state_ = State::ERRORED);
 		}
 		
-		std::vector<std::uint8_t> source(remaining);
 		std::vector<std::uint8_t> dest(decompressed_size);
 		uLongf dest_len = decompressed_size;
-		uLongf source_len = remaining;
-		stream.get(source.data(), source_len);
-		
-		auto ret = uncompress(dest.data(), &dest_len, source.data(), compressed_size);
+
+		// decompress straight out of the stream's buffer if possible
+		auto source = reinterpret_cast<const Bytef*>(stream.view(compressed_size));
+		auto ret = uncompress(dest.data(), &dest_len, source, compressed_size);
 
 		if(ret != Z_OK) {
 			LOG_DEBUG_GLOB << "Decompression of addon data failed with code " << ret << LOG_ASYNC;
@@ -113,7 +124,7 @@ public:
 		be::little_to_native_inplace(seed);
 
 		return (state_ = State::DONE);
-	} catch(spark::buffer_underrun&) {
+	} catch(spark::exception&) { // underrun or unterminated username
 		return State::ERRORED;
 	}
 
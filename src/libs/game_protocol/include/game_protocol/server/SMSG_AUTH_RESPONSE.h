@@ -22,6 +22,8 @@ class SMSG_AUTH_RESPONSE final : public ServerPacket {
 	State state_ = State::INITIAL;
 
 public:
+	static const std::size_t MAX_WIRE_LENGTH = 10;
+
 	SMSG_AUTH_RESPONSE() : ServerPacket(protocol::ServerOpcodes::SMSG_AUTH_RESPONSE) { }
 
 	Result result;
@@ -57,6 +59,11 @@ public:
 	}
 
 	void write_to_stream(spark::SafeBinaryStream& stream) const override {
+		write_body(stream);
+	}
+
+	template<typename StreamT>
+	void write_body(StreamT& stream) const {
 		stream << be::native_to_little(result);
 
 		if(result == Result::AUTH_WAIT_QUEUE) {
@@ -81,6 +81,11 @@ public:
 	}
 
 	void write_to_stream(spark::SafeBinaryStream& stream) const override {
+		write_body(stream);
+	}
+
+	template<typename StreamT>
+	void write_body(StreamT& stream) const {
 		stream << std::uint8_t(characters.size());
 
 		for(auto& c : characters) {
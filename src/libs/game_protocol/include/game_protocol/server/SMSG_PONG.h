@@ -22,6 +22,8 @@ class SMSG_PONG final : public ServerPacket {
 	State state_ = State::INITIAL;
 
 public:
+	static const std::size_t MAX_WIRE_LENGTH = 4;
+
 	SMSG_PONG() : ServerPacket(protocol::ServerOpcodes::SMSG_PONG) { }
 
 	std::uint32_t sequence_id;
@@ -39,6 +41,11 @@ public:
 	}
 
 	void write_to_stream(spark::SafeBinaryStream& stream) const override {
+		write_body(stream);
+	}
+
+	template<typename StreamT>
+	void write_body(StreamT& stream) const {
 		stream << be::native_to_little(sequence_id);
 	}
 };
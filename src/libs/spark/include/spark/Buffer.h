@@ -17,6 +17,8 @@ namespace ember { namespace spark {
 
 class Buffer {
 public:
+	static const std::size_t npos = static_cast<std::size_t>(-1);
+
 	virtual ~Buffer() = default;
 	virtual void read(void* destination, std::size_t length) = 0;
 	virtual void copy(void* destination, std::size_t length) const = 0;
@@ -26,6 +28,8 @@ public:
 	virtual std::size_t size() const = 0;
 	virtual void clear() = 0;
 	virtual bool empty() = 0;
+	virtual std::size_t find_first_of(char value, std::size_t length) const = 0;
+	virtual const char* contiguous_data(std::size_t length) const = 0;
 	virtual char& operator[](const std::size_t index) = 0;
 };
 
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <flatbuffers/flatbuffers.h>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+struct BuilderPoolStats {
+	std::size_t acquired;
+	std::size_t reused;    // acquisitions served from the free list
+	std::size_t returned;  // builders cleared and put back into the free list
+	std::size_t discarded; // builders destroyed due to the pool limits
+};
+
+/*
+ * Per-thread pool of FlatBufferBuilders. Handles returned by acquire() are
+ * ordinary shared_ptrs that put the builder back into the pool once the
+ * last reference goes away, which for a message passed to Service::send and
+ * friends is when its write has completed. Clearing a builder keeps its
+ * memory, so reused builders don't have to grow from scratch.
+ *
+ * As with TLSBlockAllocator, a builder is returned to the pool of whichever
+ * thread releases it. Builders that grew beyond MAX_RETAINED_SIZE are freed
+ * rather than pooled, as are any released once the pool holds MAX_POOLED.
+ */
+class BuilderPool final {
+	static const std::size_t MAX_POOLED = 32;
+	static const std::size_t MAX_RETAINED_SIZE = 1024 * 64; // 64KB
+
+	struct Cache {
+		std::vector<std::unique_ptr<flatbuffers::FlatBufferBuilder>> builders;
+		BuilderPoolStats stats {};
+	};
+
+	static Cache& cache() {
+		thread_local Cache cache;
+		return cache;
+	}
+
+	static void release(flatbuffers::FlatBufferBuilder* fbb) {
+		std::unique_ptr<flatbuffers::FlatBufferBuilder> builder(fbb);
+		Cache& tls = cache();
+
+		if(tls.builders.size() >= MAX_POOLED || builder->GetSize() > MAX_RETAINED_SIZE) {
+			++tls.stats.discarded;
+			return;
+		}
+
+		builder->Clear();
+		tls.builders.emplace_back(std::move(builder));
+		++tls.stats.returned;
+	}
+
+public:
+	static std::shared_ptr<flatbuffers::FlatBufferBuilder> acquire() {
+		Cache& tls = cache();
+		++tls.stats.acquired;
+
+		if(tls.builders.empty()) {
+			return { new flatbuffers::FlatBufferBuilder(), &BuilderPool::release };
+		}
+
+		auto builder = tls.builders.back().release();
+		tls.builders.pop_back();
+		++tls.stats.reused;
+		return { builder, &BuilderPool::release };
+	}
+
+	static const BuilderPoolStats& stats() {
+		return cache().stats;
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
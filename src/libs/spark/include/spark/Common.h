@@ -8,11 +8,13 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <spark/temp/MessageRoot_generated.h>
 #include <spark/temp/Multicast_generated.h>
 #include <boost/optional.hpp>
 #include <boost/uuid/uuid.hpp>
+#include <cstddef>
 
 namespace ember { namespace spark {
 
@@ -28,4 +30,37 @@ typedef std::function<void(const spark::Link&, const boost::uuids::uuid&,
 typedef std::function<void(const Endpoint*)> ResolveCallback;
 typedef std::function<void(const messaging::multicast::LocateAnswer*)> LocateCallback;
 
+// messages waiting in each priority's outbound queue, from Bulk to Control
+const std::size_t PRIORITY_LANES = 4;
+typedef std::array<std::size_t, PRIORITY_LANES> LaneDepths;
+
+// a full outbound queue refuses messages until it drains below the low marks
+struct WaterMarks {
+	std::size_t high_bytes;
+	std::size_t low_bytes;
+	std::size_t high_messages;
+	std::size_t low_messages;
+};
+
+// caps the queued data gathered into a single write
+struct FlushLimits {
+	std::size_t max_messages;
+	std::size_t max_bytes;
+};
+
+// links on which inbound messages skip full verification, if the peer agrees
+enum class Trust {
+	NONE, LOCAL, ALL
+};
+
+// how a message sent to a full outbound queue is handled - only Bulk and Normal messages are dropped
+enum class Overflow {
+	FAIL_FAST, DROP_OLDEST
+};
+
+// what became of a message handed to a session to be sent
+enum class WriteResult {
+	QUEUED, QUEUE_FULL, CLOSED, TOO_LARGE
+};
+
 }} // spark, ember
\ No newline at end of file
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <zlib.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace ember { namespace spark {
+
+/*
+ * zlib streams that live for the duration of a session. Every message is
+ * flushed with Z_SYNC_FLUSH so the peer can inflate it as soon as it arrives,
+ * but the window is carried over between messages, so strings repeated from
+ * earlier messages compress well. That does mean that every deflated message
+ * must be inflated by the peer, in order.
+ */
+class DeflateStream final {
+	z_stream stream_;
+
+public:
+	explicit DeflateStream(int level = Z_DEFAULT_COMPRESSION);
+	~DeflateStream();
+
+	DeflateStream(const DeflateStream&) = delete;
+	DeflateStream& operator=(const DeflateStream&) = delete;
+
+	// appends the compressed data to the output
+	bool deflate(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& out);
+};
+
+class InflateStream final {
+	z_stream stream_;
+
+public:
+	InflateStream();
+	~InflateStream();
+
+	InflateStream(const InflateStream&) = delete;
+	InflateStream& operator=(const InflateStream&) = delete;
+
+	// fails unless the input inflates to exactly out_size bytes
+	bool inflate(const std::uint8_t* data, std::size_t size, std::uint8_t* out, std::size_t out_size);
+};
+
+}} // spark, ember
\ No newline at end of file
@@ -13,25 +13,44 @@
 #include <spark/Link.h>
 #include <spark/temp/MessageRoot_generated.h>
 #include <spark/temp/ServiceTypes_generated.h>
-#include <forward_list>
-#include <shared_mutex>
-#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <vector>
+#include <cstddef>
 
 namespace ember { namespace spark {
 
+/*
+ * Handlers are stored in a table indexed directly by service, so dispatching
+ * never takes a lock. Each slot counts the dispatches that may be using its
+ * handler, split across two epochs. Replacing or removing a handler retires
+ * the current epoch and waits for its dispatches to drain, meaning a handler
+ * can be safely destroyed once remove_handler returns. New dispatches count
+ * against the next epoch, so a busy service can't stall removal indefinitely.
+ */
 class EventDispatcher {
 public:
 	enum class Mode { CLIENT, SERVER, BOTH };
 
 private:
-	struct Handler {
-		Mode mode;
-		EventHandler* handler;
+	static const std::size_t MAX_SERVICES = static_cast<std::size_t>(messaging::Service::MAX) + 1;
+
+	struct Slot {
+		std::atomic<EventHandler*> handler { nullptr };
+		std::atomic<unsigned int> epoch { 0 };
+		mutable std::array<std::atomic<std::size_t>, 2> active {};
+		Mode mode = Mode::BOTH;
 	};
 
-	std::unordered_map<messaging::Service, Handler> handlers_;
-	mutable std::shared_timed_mutex lock_;
+	std::array<Slot, MAX_SERVICES> handlers_;
+	mutable std::mutex lock_; // serialises registration & removal only
+
+	static bool in_range(messaging::Service service);
+	void replace_handler(Slot& slot, EventHandler* handler);
+
+	template<typename Func>
+	void dispatch(messaging::Service service, Func&& func) const;
 
 public:
 	std::vector<messaging::Service> services(Mode mode) const;
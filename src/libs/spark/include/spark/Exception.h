@@ -30,4 +30,23 @@ public:
 		            buff_size(buff_size), read_size(read_size) { }
 };
 
+class buffer_overflow : public exception {
+public:
+	const std::size_t write_size, free_size;
+
+	buffer_overflow(std::size_t write_size, std::size_t free_size)
+		: exception("Buffer overflow - " + std::to_string(write_size) + " byte write requested, buffer has "
+		            + std::to_string(free_size) + " bytes free"),
+		            write_size(write_size), free_size(free_size) { }
+};
+
+class stream_read_limit : public exception {
+public:
+	const std::size_t max_length;
+
+	stream_read_limit(std::size_t max_length)
+		: exception("Read limit exceeded - no terminator within " + std::to_string(max_length)
+		            + " bytes"), max_length(max_length) { }
+};
+
 }} //spark, ember
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+/*
+ * For idempotent requests that can safely be answered by any peer providing the
+ * service. See Service::send_hedged.
+ */
+struct RequestPolicy {
+	std::size_t attempts;              // including the first
+	bool hedge;                        // send another attempt while the last is outstanding
+	bool retry;                        // send another attempt as soon as the last fails
+	double percentile;                 // of recent latencies, waited for before hedging
+	std::chrono::milliseconds delay;   // minimum wait before hedging
+	std::chrono::milliseconds timeout; // for each attempt
+};
+
+/*
+ * Latencies of the most recent requests to a service, used to decide how long
+ * a request should be given before it's hedged.
+ */
+class LatencyWindow {
+	static const std::size_t SAMPLES = 256;
+	static const std::size_t MIN_SAMPLES = 20;
+
+	std::array<std::chrono::microseconds, SAMPLES> samples_;
+	std::size_t count_ = 0;
+	std::size_t next_ = 0;
+	mutable std::mutex lock_;
+
+public:
+	void record(std::chrono::microseconds latency) {
+		std::lock_guard<std::mutex> guard(lock_);
+		samples_[next_] = latency;
+		next_ = (next_ + 1) % SAMPLES;
+
+		if(count_ < SAMPLES) {
+			++count_;
+		}
+	}
+
+	// nothing is returned until there are enough samples for the result to mean anything
+	boost::optional<std::chrono::microseconds> percentile(double percentile) const {
+		std::unique_lock<std::mutex> guard(lock_);
+
+		if(count_ < MIN_SAMPLES) {
+			return boost::none;
+		}
+
+		auto samples = samples_;
+		const auto count = count_;
+		guard.unlock();
+
+		percentile = std::min(std::max(percentile, 0.0), 1.0);
+		const auto nth = samples.begin() + static_cast<std::size_t>(percentile * (count - 1));
+		std::nth_element(samples.begin(), nth, samples.begin() + count);
+		return *nth;
+	}
+};
+
+/*
+ * Hedges and retries are paid for by the requests that precede them, so they
+ * can't multiply the load on a tier that's already struggling. Each request
+ * earns a fraction of a token, each additional attempt spends a whole one and
+ * the balance is capped so that quiet periods can't bank an unlimited burst.
+ */
+class RetryBudget {
+	double ratio_;
+	double cap_;
+	double balance_;
+	std::mutex lock_;
+
+public:
+	RetryBudget(double ratio, double cap) : ratio_(ratio), cap_(cap), balance_(cap) { }
+
+	void deposit() {
+		std::lock_guard<std::mutex> guard(lock_);
+		balance_ = std::min(balance_ + ratio_, cap_);
+	}
+
+	bool withdraw() {
+		std::lock_guard<std::mutex> guard(lock_);
+
+		if(balance_ < 1.0) {
+			return false;
+		}
+
+		balance_ -= 1.0;
+		return true;
+	}
+
+	void reset(double ratio, double cap) {
+		std::lock_guard<std::mutex> guard(lock_);
+		ratio_ = ratio;
+		cap_ = cap;
+		balance_ = std::min(balance_, cap_);
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <spark/Common.h>
+#include <spark/SharedChannel.h>
 #include <logger/Logging.h>
 #include <boost/asio.hpp>
+#include <memory>
+#include <string>
 
 namespace ember { namespace spark {
 
@@ -24,21 +28,34 @@ class Listener {
 	boost::asio::ip::tcp::acceptor acceptor_;
 	boost::asio::ip::tcp::socket socket_;
 
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	boost::asio::local::stream_protocol::acceptor local_acceptor_;
+	boost::asio::local::stream_protocol::socket local_socket_;
+	std::string local_path_;
+
+	void receive_handshake(std::shared_ptr<boost::asio::local::stream_protocol::socket> socket);
+#endif
+
 	SessionManager& sessions_;
 	log::Logger* logger_;
 	log::Filter filter_;
 	const Link& link_;
 	const EventDispatcher& handlers_;
 	ServicesMap& services_;
+	Trust trust_;
 
 	void accept_connection();
-	void start_session(boost::asio::ip::tcp::socket socket);
+	void accept_local_connection();
+	void start_session(boost::asio::generic::stream_protocol::socket socket,
+	                   std::unique_ptr<SharedChannel> channel = nullptr);
 
 public:
 	Listener(boost::asio::io_service& service, std::string interface, std::uint16_t port,
 	         SessionManager& sessions, const EventDispatcher& handlers, ServicesMap& services,
 	         const Link& link, log::Logger* logger, log::Filter filter);
 
+	void listen_local(const std::string& path);
+	void trust(Trust trust);
 	void shutdown();
 };
 
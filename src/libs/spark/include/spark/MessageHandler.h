@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <spark/Common.h>
 #include <spark/Link.h>
 #include <spark/ServicesMap.h>
 #include <spark/temp/MessageRoot_generated.h>
@@ -15,6 +16,7 @@
 #include <set>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 namespace ember { namespace spark {
 
@@ -23,6 +25,8 @@ class EventDispatcher;
 class LinkMap;
 
 class MessageHandler {
+	const std::size_t COMPRESSION_THRESHOLD = 512;
+
 	enum class State {
 		HANDSHAKING, NEGOTIATING, FORWARDING
 	} state_ = State::HANDSHAKING;
@@ -35,19 +39,24 @@ class MessageHandler {
 	log::Filter filter_;
 	std::set<std::int32_t> matches_;
 	bool initiator_;
+	Trust trust_;
+	bool trusted_;
 
 	void dispatch_message(const messaging::MessageRoot* message);
+	bool dispatch_batch(const messaging::Batch* batch);
 	bool negotiate_protocols(NetworkSession& net, const messaging::MessageRoot* message);
 	bool establish_link(NetworkSession& net, const messaging::MessageRoot* message);
 	void send_banner(NetworkSession& net);
 	void send_negotiation(NetworkSession& net);
+	bool offer_trust(const NetworkSession& net) const;
 
 public:
 	MessageHandler(const EventDispatcher& dispatcher, ServicesMap& services, const Link& link,
-	               bool initiator, log::Logger* logger, log::Filter filter);
+	               bool initiator, Trust trust, log::Logger* logger, log::Filter filter);
 	~MessageHandler();
 
-	bool handle_message(NetworkSession& net, const std::vector<std::uint8_t>& buffer);
+	static bool verify(const std::uint8_t* data, std::size_t size, bool trusted);
+	bool handle_message(NetworkSession& net, const std::uint8_t* data, std::size_t size);
 	void start(NetworkSession& net);
 };
 
@@ -8,7 +8,10 @@
 
 #pragma once
 
+#include <spark/Common.h>
 #include <spark/MessageHandler.h>
+#include <spark/Compression.h>
+#include <spark/SharedChannel.h>
 #include <spark/SessionManager.h>
 #include <spark/buffers/ChainedBuffer.h>
 #include <logger/Logging.h>
@@ -17,60 +20,195 @@
 #include <flatbuffers/flatbuffers.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 
 namespace ember { namespace spark {
 
 class NetworkSession : public std::enable_shared_from_this<NetworkSession> {
 	const std::size_t MAX_MESSAGE_LENGTH = 1024 * 1024;  // 1MB
 	const std::size_t DEFAULT_BUFFER_LENGTH = 1024 * 16; // 16KB
-	enum class ReadState { HEADER, BODY };
-
-	boost::asio::ip::tcp::socket socket_;
+	const std::size_t DEFAULT_FLUSH_MESSAGES = 32;
+	const std::size_t DEFAULT_FLUSH_BYTES = 1024 * 64;   // 64KB
+	const std::size_t COMPRESSION_SLACK = 1024;          // worst case deflate expansion
+	const WaterMarks DEFAULT_WATER_MARKS { 1024 * 1024 * 32, 1024 * 1024 * 16, 65536, 32768 };
+	typedef std::uint32_t LengthPrefix;
+
+	/*
+	 * The top bit of the length prefix marks a compressed message, which is
+	 * followed by its inflated length and then the deflated data.
+	 */
+	const LengthPrefix COMPRESSED_FLAG = 0x80000000;
+
+	struct QueuedMessage {
+		LengthPrefix length; // little-endian, written inline ahead of the body
+		std::shared_ptr<flatbuffers::FlatBufferBuilder> fbb;
+		std::vector<std::uint8_t> deflated; // used in place of the builder if set
+	};
+
+	boost::asio::generic::stream_protocol::socket socket_;
 	boost::asio::strand strand_;
 
-	ReadState state_;
-	std::uint32_t body_read_size;
+	/*
+	 * Inbound data is read ahead into a single buffer, as much as the socket has
+	 * available, and every complete message is dispatched in place. Only the
+	 * trailing partial message, if any, is moved to the front of the buffer.
+	 */
 	std::vector<std::uint8_t> in_buff_;
+	std::size_t read_offset_;
+	std::size_t write_offset_;
 	SessionManager& sessions_;
 	MessageHandler handler_;
 	const std::string remote_;
+	const bool local_;
 	log::Logger* logger_; 
 	log::Filter filter_;
 	bool stopped_;
 
-	bool process_header() {
-		std::memcpy(&body_read_size, in_buff_.data(), sizeof(body_read_size));
-		boost::endian::little_to_native_inplace(body_read_size);
-	
-		if(body_read_size > MAX_MESSAGE_LENGTH) {
-			LOG_WARN_FILTER(logger_, filter_)
-				<< "[spark] Peer at " << remote_host()
-				<< " attempted to send a message of "
-				<< body_read_size << " bytes" << LOG_ASYNC;
+	/*
+	 * Each priority has its own queue, drained highest first, so that control
+	 * traffic and replies don't wait behind bulk messages. Messages are moved
+	 * out of their queues once they're part of a write.
+	 */
+	std::array<std::deque<QueuedMessage>, PRIORITY_LANES> lanes_;
+	std::array<std::atomic<std::size_t>, PRIORITY_LANES> lane_depths_;
+	std::vector<QueuedMessage> in_flight_;
+	std::vector<boost::asio::const_buffer> send_buffers_;
+	std::atomic<std::size_t> queued_;
+	std::atomic<std::size_t> queued_bytes_;
+	std::size_t in_flight_bytes_;
+	std::size_t dropped_;
+	WaterMarks water_marks_;
+	std::atomic_bool congested_;
+	std::atomic_bool batching_;
+	std::size_t max_flush_messages_;
+	std::size_t max_flush_bytes_;
+	std::mutex send_lock_;
+
+	// outbound compression is enabled once negotiated, inbound is always accepted
+	std::unique_ptr<DeflateStream> deflater_;
+	std::unique_ptr<InflateStream> inflater_;
+	std::vector<std::uint8_t> inflated_;
+	std::size_t compression_threshold_;
+
+	// shared memory used in place of the socket, if the connecting side set it up
+	std::unique_ptr<SharedChannel> channel_;
+	std::vector<std::uint8_t> channel_buff_;
+
+	LengthPrefix peek_prefix() const {
+		LengthPrefix prefix;
+		std::memcpy(&prefix, in_buff_.data() + read_offset_, sizeof(prefix));
+		return boost::endian::little_to_native(prefix);
+	}
+
+	bool inflate(const std::uint8_t* data, std::size_t size) {
+		LengthPrefix inflated_size;
 
+		if(size < sizeof(inflated_size)) {
 			return false;
 		}
 
-		if(body_read_size > in_buff_.size()) {
-			LOG_WARN_FILTER(logger_, filter_)
-				<< "[spark] Peer at " << remote_host()
-				<< " attempted to send a message of "
-				<< body_read_size << " bytes" << LOG_ASYNC;
+		std::memcpy(&inflated_size, data, sizeof(inflated_size));
+		boost::endian::little_to_native_inplace(inflated_size);
 
-			in_buff_.resize(body_read_size);
+		if(inflated_size > MAX_MESSAGE_LENGTH) {
+			return false;
+		}
+
+		if(!inflater_) {
+			inflater_ = std::make_unique<InflateStream>();
+		}
+
+		// don't hang on to the memory from an unusually large message
+		if(inflated_.capacity() > DEFAULT_BUFFER_LENGTH && inflated_size <= DEFAULT_BUFFER_LENGTH) {
+			std::vector<std::uint8_t>().swap(inflated_);
+		}
+
+		inflated_.resize(inflated_size);
+		return inflater_->inflate(data + sizeof(inflated_size), size - sizeof(inflated_size),
+		                          inflated_.data(), inflated_.size());
+	}
+
+	bool process_messages() {
+		while(write_offset_ - read_offset_ >= sizeof(LengthPrefix)) {
+			const LengthPrefix prefix = peek_prefix();
+			const bool compressed = (prefix & COMPRESSED_FLAG) != 0;
+			const LengthPrefix length = prefix & ~COMPRESSED_FLAG;
+
+			if(length > MAX_MESSAGE_LENGTH + (compressed? COMPRESSION_SLACK : 0)) {
+				LOG_WARN_FILTER(logger_, filter_)
+					<< "[spark] Peer at " << remote_host()
+					<< " attempted to send a message of "
+					<< length << " bytes" << LOG_ASYNC;
+
+				return false;
+			}
+
+			if(write_offset_ - read_offset_ - sizeof(LengthPrefix) < length) {
+				break;
+			}
+
+			const auto message = in_buff_.data() + read_offset_ + sizeof(LengthPrefix);
+
+			if(compressed) {
+				if(!inflate(message, length)) {
+					LOG_WARN_FILTER(logger_, filter_)
+						<< "[spark] Unable to inflate message from " << remote_host() << LOG_ASYNC;
+					return false;
+				}
+
+				if(!handler_.handle_message(*this, inflated_.data(), inflated_.size())) {
+					return false;
+				}
+			} else if(!handler_.handle_message(*this, message, length)) {
+				return false;
+			}
+
+			read_offset_ += sizeof(LengthPrefix) + length;
 		}
 
 		return true;
 	}
 
-	void handle_read(boost::system::error_code ec) {
+	/*
+	 * Ensures the buffer can hold the whole of the next message. The buffer
+	 * only grows beyond its default length to fit a large message and is
+	 * released as soon as that message has been handled.
+	 */
+	void prepare_buffer() {
+		const std::size_t pending = write_offset_ - read_offset_;
+		std::size_t required = DEFAULT_BUFFER_LENGTH;
+
+		if(pending >= sizeof(LengthPrefix)) {
+			required = std::max<std::size_t>(required, sizeof(LengthPrefix) + (peek_prefix() & ~COMPRESSED_FLAG));
+		}
+
+		const bool shrink = in_buff_.size() > required;
+
+		if(!pending || shrink || in_buff_.size() - read_offset_ < required) {
+			std::memmove(in_buff_.data(), in_buff_.data() + read_offset_, pending);
+			read_offset_ = 0;
+			write_offset_ = pending;
+		}
+
+		if(in_buff_.size() < required) {
+			in_buff_.resize(required);
+		} else if(shrink) {
+			in_buff_.resize(required);
+			in_buff_.shrink_to_fit();
+		}
+	}
+
+	void handle_read(boost::system::error_code ec, std::size_t size) {
 		if(ec) {
 			if(ec != boost::asio::error::operation_aborted) {
 				close_session();
@@ -79,34 +217,322 @@ class NetworkSession : public std::enable_shared_from_this<NetworkSession> {
 			return;
 		}
 
-		if(state_ == ReadState::HEADER) {
-			if(process_header()) {
-				state_ = ReadState::BODY;
-				read();
-				return;
-			}
-		} else if(handler_.handle_message(*this, in_buff_)) {
-			state_ = ReadState::HEADER;
-			read();
+		write_offset_ += size;
+
+		if(!process_messages()) {
+			close_session();
 			return;
 		}
 
-		close_session();
+		prepare_buffer();
+		read();
 	}
 
 	void read() {
 		auto self(shared_from_this());
-		std::size_t read_size = state_ == ReadState::HEADER? sizeof(body_read_size) : body_read_size;
+		auto buffer = boost::asio::buffer(in_buff_.data() + write_offset_, in_buff_.size() - write_offset_);
 
-		boost::asio::async_read(socket_, boost::asio::buffer(in_buff_, read_size), strand_.wrap(
+		socket_.async_read_some(buffer, strand_.wrap(
 			[this, self](boost::system::error_code ec, std::size_t size) {
 				if(!stopped_) {
-					handle_read(ec);
+					handle_read(ec, size);
 				}
 			}
 		));
 	}
 
+	static std::size_t lane_index(messaging::Priority priority) {
+		return priority == messaging::Priority::Default? lane_index(messaging::Priority::Normal)
+			: static_cast<std::size_t>(priority) - static_cast<std::size_t>(messaging::Priority::Bulk);
+	}
+
+	void pop_lane(std::size_t index) {
+		lanes_[index].pop_front();
+		--lane_depths_[index];
+	}
+
+	// send_lock_ must be held by the caller
+	void sent(std::size_t messages, std::size_t bytes) {
+		queued_ -= messages;
+		queued_bytes_ -= bytes;
+
+		if(congested_ && queued_bytes_ <= water_marks_.low_bytes && queued_ <= water_marks_.low_messages) {
+			congested_ = false;
+
+			LOG_DEBUG_FILTER(logger_, filter_)
+				<< "[spark] Outbound queue to " << remote_host() << " has drained" << LOG_ASYNC;
+		}
+	}
+
+	/*
+	 * Drops the oldest Bulk and Normal messages until there's room for another
+	 * message. Replies and control messages are never dropped, as the peer has no
+	 * way of finding out, and neither are messages already being written.
+	 * send_lock_ must be held by the caller
+	 */
+	bool make_room(std::size_t size, Overflow overflow,
+	               std::vector<std::shared_ptr<flatbuffers::FlatBufferBuilder>>* dropped) {
+		const auto full = [&]() {
+			return queued_bytes_ + size > water_marks_.high_bytes || queued_ >= water_marks_.high_messages;
+		};
+
+		if(!congested_) {
+			return true;
+		}
+
+		if(overflow == Overflow::FAIL_FAST) {
+			return false;
+		}
+
+		std::size_t count = 0;
+
+		for(std::size_t i = 0; i < lane_index(messaging::Priority::Reply) && full(); ++i) {
+			while(!lanes_[i].empty() && full()) {
+				auto& message = lanes_[i].front();
+				--queued_;
+				queued_bytes_ -= message.fbb->GetSize();
+				++count;
+
+				if(dropped) {
+					dropped->emplace_back(std::move(message.fbb));
+				}
+
+				pop_lane(i);
+			}
+		}
+
+		if(count) {
+			dropped_ += count;
+
+			LOG_WARN_FILTER(logger_, filter_)
+				<< "[spark] Dropped " << count << " queued messages to " << remote_host()
+				<< " to make room, " << dropped_ << " in total" << LOG_ASYNC;
+		}
+
+		return !full();
+	}
+
+	bool has_queued() const {
+		return std::any_of(lanes_.begin(), lanes_.end(), [](const auto& lane) { return !lane.empty(); });
+	}
+
+	/*
+	 * Gathers as many queued messages as the limits allow into a single write,
+	 * highest priority first. Compression happens here rather than when the
+	 * message is queued, as the peer has to inflate in the order they're sent.
+	 * send_lock_ must be held by the caller
+	 */
+	void flush() {
+		std::size_t bytes = 0;
+
+		for(std::size_t i = PRIORITY_LANES; i-- > 0;) {
+			while(!lanes_[i].empty()) {
+				auto& message = lanes_[i].front();
+
+				// always send at least one message, regardless of its size
+				if(!in_flight_.empty() && (in_flight_.size() == max_flush_messages_
+				   || bytes + sizeof(message.length) + message.fbb->GetSize() > max_flush_bytes_)) {
+					i = 0;
+					break;
+				}
+
+				in_flight_bytes_ += message.fbb->GetSize();
+
+				if(deflater_ && message.fbb->GetSize() >= compression_threshold_) {
+					// the peer's stream would be out of step, so the link can't continue
+					if(!deflate(message)) {
+						close_deferred();
+						return;
+					}
+				}
+
+				bytes += sizeof(message.length) + (message.fbb? message.fbb->GetSize() : message.deflated.size());
+				in_flight_.emplace_back(std::move(message));
+				pop_lane(i);
+			}
+		}
+
+		// buffers are only taken once the vector is done reallocating
+		send_buffers_.clear();
+
+		for(auto& message : in_flight_) {
+			send_buffers_.emplace_back(&message.length, sizeof(message.length));
+
+			if(message.fbb) {
+				send_buffers_.emplace_back(message.fbb->GetBufferPointer(), message.fbb->GetSize());
+			} else {
+				send_buffers_.emplace_back(message.deflated.data(), message.deflated.size());
+			}
+		}
+
+		auto self(shared_from_this());
+
+		boost::asio::async_write(socket_, send_buffers_, strand_.wrap(
+			[this, self](boost::system::error_code ec, std::size_t /*size*/) {
+				if(ec) {
+					if(ec != boost::asio::error::operation_aborted) {
+						close_session();
+					}
+
+					return;
+				}
+
+				std::lock_guard<std::mutex> guard(send_lock_);
+				sent(in_flight_.size(), in_flight_bytes_);
+				in_flight_.clear();
+				in_flight_bytes_ = 0;
+
+				if(has_queued()) {
+					flush();
+				}
+			}
+		));
+	}
+
+	/*
+	 * The peer can still write to the ring, so each message is copied out before
+	 * it's verified, otherwise it could be changed after it passed. The socket
+	 * is still read to detect disconnects.
+	 */
+	bool process_channel() {
+		auto& ring = channel_->inbound();
+		const std::uint8_t* data;
+		std::size_t size;
+
+		do {
+			while(ring.peek(data, size)) {
+				if(!data || size > MAX_MESSAGE_LENGTH) {
+					LOG_WARN_FILTER(logger_, filter_)
+						<< "[spark] Peer at " << remote_host()
+						<< " wrote a malformed message to shared memory" << LOG_ASYNC;
+
+					return false;
+				}
+
+				channel_buff_.assign(data, data + size);
+				ring.pop(size);
+
+				if(!handler_.handle_message(*this, channel_buff_.data(), channel_buff_.size())) {
+					return false;
+				}
+			}
+
+			if(ring.wake_producer()) {
+				channel_->notify();
+			}
+		} while(!ring.consumer_wait());
+
+		// the notification may have been for space in the outbound ring
+		std::lock_guard<std::mutex> guard(send_lock_);
+		flush_channel();
+		return true;
+	}
+
+	void handle_channel() {
+		if(!process_channel()) {
+			close_session();
+			return;
+		}
+
+		auto self(shared_from_this());
+
+		channel_->async_wait(strand_.wrap([this, self](boost::system::error_code ec) {
+			if(stopped_) {
+				return;
+			}
+
+			if(ec) {
+				if(ec != boost::asio::error::operation_aborted) {
+					close_session();
+				}
+
+				return;
+			}
+
+			handle_channel();
+		}));
+	}
+
+	// send_lock_ must be held by the caller
+	void flush_channel() {
+		auto& ring = channel_->outbound();
+		bool written = false;
+
+		for(std::size_t i = PRIORITY_LANES; i-- > 0;) {
+			while(!lanes_[i].empty()) {
+				const auto& fbb = lanes_[i].front().fbb;
+
+				if(!ring.write(fbb->GetBufferPointer(), fbb->GetSize())) {
+					// the consumer will notify us once it has made space, unless it already has
+					ring.producer_wait();
+
+					if(!ring.write(fbb->GetBufferPointer(), fbb->GetSize())) {
+						// lower priority messages have to wait as well
+						i = 0;
+						break;
+					}
+				}
+
+				sent(1, fbb->GetSize());
+				pop_lane(i);
+				written = true;
+			}
+		}
+
+		if(written && ring.wake_consumer()) {
+			channel_->notify();
+		}
+	}
+
+	// replaces the message's builder with its deflated body, send_lock_ must be held by the caller
+	bool deflate(QueuedMessage& message) {
+		auto& fbb = *message.fbb;
+		auto& deflated = message.deflated;
+		const auto inflated_size = boost::endian::native_to_little(static_cast<LengthPrefix>(fbb.GetSize()));
+		deflated.resize(sizeof(inflated_size));
+		std::memcpy(deflated.data(), &inflated_size, sizeof(inflated_size));
+
+		if(!deflater_->deflate(fbb.GetBufferPointer(), fbb.GetSize(), deflated)) {
+			LOG_ERROR_FILTER(logger_, filter_)
+				<< "[spark] Unable to deflate message to " << remote_host() << LOG_ASYNC;
+			return false;
+		}
+
+		message.length = boost::endian::native_to_little(static_cast<LengthPrefix>(deflated.size()) | COMPRESSED_FLAG);
+		message.fbb.reset();
+		return true;
+	}
+
+	static bool is_local(const boost::asio::generic::stream_protocol::socket& socket) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		boost::system::error_code ec;
+		const auto endpoint = socket.local_endpoint(ec);
+		return !ec && endpoint.protocol().family() == AF_UNIX;
+#else
+		return false;
+#endif
+	}
+
+	// peers on the same host connect over a local socket, which won't have an address
+	static std::string describe(const boost::asio::generic::stream_protocol::socket& socket) {
+		const auto endpoint = socket.remote_endpoint();
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		if(endpoint.protocol().family() == AF_UNIX) {
+			// only the connecting side sees a named peer
+			auto named = endpoint.size() > offsetof(sockaddr_un, sun_path)? endpoint : socket.local_endpoint();
+			boost::asio::local::stream_protocol::endpoint local;
+			std::memcpy(local.data(), named.data(), named.size());
+			local.resize(named.size());
+			return "unix:" + local.path();
+		}
+#endif
+
+		boost::asio::ip::tcp::endpoint tcp;
+		std::memcpy(tcp.data(), endpoint.data(), endpoint.size());
+		tcp.resize(endpoint.size());
+		return tcp.address().to_string() + ":" + std::to_string(tcp.port());
+	}
 
 	void stop() {
 		LOG_DEBUG_FILTER(logger_, filter_)
@@ -114,67 +540,172 @@ class NetworkSession : public std::enable_shared_from_this<NetworkSession> {
 
 		stopped_ = true;
 		boost::system::error_code ec; // we don't care about any errors
-		socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+		socket_.shutdown(boost::asio::socket_base::shutdown_both, ec);
 		socket_.close(ec);
+
+		if(channel_) {
+			channel_->close();
+		}
 	}
 
 public:
-	NetworkSession(SessionManager& sessions, boost::asio::ip::tcp::socket socket, MessageHandler handler,
-	               log::Logger* logger, log::Filter filter)
-	               : sessions_(sessions), socket_(std::move(socket)), body_read_size(0),
+	NetworkSession(SessionManager& sessions, boost::asio::generic::stream_protocol::socket socket, MessageHandler handler,
+	               log::Logger* logger, log::Filter filter, std::unique_ptr<SharedChannel> channel = nullptr)
+	               : sessions_(sessions), socket_(std::move(socket)), read_offset_(0), write_offset_(0),
 	                 handler_(handler), logger_(logger), filter_(filter), stopped_(false),
-	                 state_(ReadState::HEADER), in_buff_(DEFAULT_BUFFER_LENGTH),
-	                 strand_(socket_.get_io_service()),
-	                 remote_(socket_.remote_endpoint().address().to_string()
-	                         + ":" + std::to_string(socket_.remote_endpoint().port())) { }
+	                 in_buff_(DEFAULT_BUFFER_LENGTH),
+	                 strand_(socket_.get_io_service()), lane_depths_ {}, queued_(0), queued_bytes_(0),
+	                 in_flight_bytes_(0), dropped_(0), water_marks_(DEFAULT_WATER_MARKS), congested_(false), batching_(false),
+	                 max_flush_messages_(DEFAULT_FLUSH_MESSAGES), max_flush_bytes_(DEFAULT_FLUSH_BYTES),
+	                 compression_threshold_(0),
+	                 channel_(std::move(channel)), remote_(describe(socket_)), local_(is_local(socket_)) { }
 
 	void start() {
 		handler_.start(*this);
 		read();
+
+		// anything the peer wrote before we started won't have been signalled
+		if(channel_) {
+			auto self(shared_from_this());
+			strand_.dispatch([this, self]() {
+				handle_channel();
+			});
+		}
 	}
 
 	void close_session() {
 		sessions_.stop(shared_from_this());
 	}
 
+	// for when send_lock_ is held, as stopping the session takes the manager's lock
+	void close_deferred() {
+		auto self(shared_from_this());
+
+		strand_.post([this, self]() {
+			close_session();
+		});
+	}
+
 	std::string remote_host() {
 		return remote_;
 	}
 
-	void write(std::shared_ptr<flatbuffers::FlatBufferBuilder> fbb) {
+	// whether the peer is connected over a local socket, on this host
+	bool local() const {
+		return local_;
+	}
+
+	// whether messages are carried over shared memory rather than the socket
+	bool shared() const {
+		return channel_ != nullptr;
+	}
+
+	/*
+	 * Control messages are always queued unless the session is closed, as they're
+	 * needed to keep the link alive. Messages dropped to make room for this one
+	 * are handed back, if asked for.
+	 */
+	WriteResult write(std::shared_ptr<flatbuffers::FlatBufferBuilder> fbb,
+	           messaging::Priority priority = messaging::Priority::Normal,
+	           Overflow overflow = Overflow::FAIL_FAST,
+	           std::vector<std::shared_ptr<flatbuffers::FlatBufferBuilder>>* dropped = nullptr) {
 		if(!socket_.is_open()) {
-			return;
+			return WriteResult::CLOSED;
 		}
 
-		auto size = static_cast<decltype(body_read_size)>(fbb->GetSize());
-
-		if(size > MAX_MESSAGE_LENGTH) {
+		if(fbb->GetSize() > MAX_MESSAGE_LENGTH) {
 			LOG_DEBUG_FILTER(logger_, filter_)
 				<< "[spark] Attempted to send a message larger than permitted size ("
 				<< MAX_MESSAGE_LENGTH << " bytes)" << LOG_ASYNC;
-			return;
+			return WriteResult::TOO_LARGE;
 		}
 
-		boost::endian::native_to_little_inplace(size);
+		auto size = static_cast<LengthPrefix>(fbb->GetSize());
 
-		// todo - remove this allocation - waiting for a better solution than can be achieved
-		// with the current FlatBuffers custom allocator design
-		auto size_ptr = std::make_shared<decltype(body_read_size)>(size);
+		const auto index = lane_index(priority);
+		std::lock_guard<std::mutex> guard(send_lock_);
 
-		std::array<boost::asio::const_buffer, 2> buffers {
-			boost::asio::const_buffer { size_ptr.get(), sizeof(body_read_size) },
-			boost::asio::const_buffer { fbb->GetBufferPointer(), fbb->GetSize() }
-		};
+		if(priority != messaging::Priority::Control && !make_room(size, overflow, dropped)) {
+			return WriteResult::QUEUE_FULL;
+		}
 
-		auto self(shared_from_this());
+		lanes_[index].push_back({ boost::endian::native_to_little(size), std::move(fbb), {} });
+		++lane_depths_[index];
+		++queued_;
+		queued_bytes_ += size;
 
-		socket_.async_send(buffers, strand_.wrap(
-			[this, self, fbb, size_ptr](boost::system::error_code ec, std::size_t /*size*/) {
-				if(ec && ec != boost::asio::error::operation_aborted) {
-					close_session();
-				}
-			}
-		));
+		if(!congested_ && (queued_bytes_ >= water_marks_.high_bytes || queued_ >= water_marks_.high_messages)) {
+			congested_ = true;
+
+			LOG_WARN_FILTER(logger_, filter_)
+				<< "[spark] Outbound queue to " << remote_host() << " is full" << LOG_ASYNC;
+		}
+
+		if(channel_) {
+			flush_channel();
+		} else if(in_flight_.empty()) { // otherwise, the current write's completion will pick it up
+			flush();
+		}
+
+		return WriteResult::QUEUED;
+	}
+
+	void water_marks(const WaterMarks& marks) {
+		std::lock_guard<std::mutex> guard(send_lock_);
+		water_marks_ = marks;
+	}
+
+	// whether messages are currently being refused
+	bool congested() const {
+		return congested_;
+	}
+
+	/*
+	 * Caps the amount of queued data gathered into a single write. A message
+	 * larger than the byte limit is still sent, on its own.
+	 */
+	void flush_limits(const FlushLimits& limits) {
+		std::lock_guard<std::mutex> guard(send_lock_);
+		max_flush_messages_ = std::max<std::size_t>(limits.max_messages, 1);
+		max_flush_bytes_ = limits.max_bytes;
+	}
+
+	/*
+	 * Compresses outbound messages of at least the threshold size. Must only be
+	 * enabled once the peer has confirmed that it supports compression.
+	 */
+	void enable_compression(std::size_t threshold, int level = Z_DEFAULT_COMPRESSION) {
+		std::lock_guard<std::mutex> guard(send_lock_);
+
+		if(!deflater_) {
+			deflater_ = std::make_unique<DeflateStream>(level);
+		}
+
+		compression_threshold_ = threshold;
+	}
+
+	// set once the peer has confirmed that it can unpack batched messages
+	void enable_batching() {
+		batching_ = true;
+	}
+
+	bool batching() const {
+		return batching_;
+	}
+
+	// messages queued or being written, used to balance sends across striped links
+	std::size_t outstanding() const {
+		return queued_;
+	}
+
+	LaneDepths lane_depths() const {
+		LaneDepths depths;
+
+		for(std::size_t i = 0; i < PRIORITY_LANES; ++i) {
+			depths[i] = lane_depths_[i];
+		}
+
+		return depths;
 	}
 
 	virtual ~NetworkSession() = default;
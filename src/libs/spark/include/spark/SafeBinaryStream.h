@@ -11,18 +11,50 @@
 #include <spark/Buffer.h>
 #include <spark/Exception.h>
 #include <algorithm>
+#include <array>
 #include <string>
+#include <vector>
 #include <type_traits>
 #include <cstddef>
 #include <cstring>
 
 namespace ember { namespace spark {
 
-class SafeBinaryStream {
-	Buffer& buffer_;
+// As with BasicBinaryStream, SafeBinaryStream is the type-erased variant
+template<typename BufferType>
+class BasicSafeBinaryStream {
+	static_assert(std::is_base_of<Buffer, BufferType>::value, "BufferType must implement spark::Buffer");
+
+	static const std::size_t LINEAR_BUFFER_SIZE = 64;
+
+	BufferType& buffer_;
+	std::array<char, LINEAR_BUFFER_SIZE> linear_;
+	std::vector<char> linear_large_;
+
+	char* linear_storage(std::size_t length) {
+		if(length <= linear_.size()) {
+			return linear_.data();
+		}
+
+		linear_large_.resize(length);
+		return linear_large_.data();
+	}
+
+	void read_string(std::string& dest, std::size_t length, bool terminated) {
+		const std::size_t offset = dest.size();
+		dest.resize(offset + length);
+
+		if(length) {
+			buffer_.read(&dest[offset], length);
+		}
+
+		if(terminated) {
+			buffer_.skip(1);
+		}
+	}
 
 public:
-	explicit SafeBinaryStream(Buffer& source) : buffer_(source) {}
+	explicit BasicSafeBinaryStream(BufferType& source) : buffer_(source) {}
 
 	void check_read_bounds(std::size_t read_size) {
 		if(read_size > buffer_.size()) {
@@ -32,21 +64,20 @@ public:
 
 	/**  Serialisation **/
 
-	template<typename T>
-	SafeBinaryStream& operator <<(const T& data) {
-		static_assert(std::is_trivially_copyable<T>::value, "Cannot safely copy this type");
+	template<typename T, typename = std::enable_if_t<std::is_trivially_copyable<T>::value>>
+	BasicSafeBinaryStream& operator <<(const T& data) {
 		buffer_.write(reinterpret_cast<const char*>(&data), sizeof(T));
 		return *this;
 	}
 
-	SafeBinaryStream& operator <<(const std::string& data) {
+	BasicSafeBinaryStream& operator <<(const std::string& data) {
 		buffer_.write(data.data(), data.size());
 		char term = '\0';
 		buffer_.write(&term, 1);
 		return *this;
 	}
 
-	SafeBinaryStream& operator <<(const char* data) {
+	BasicSafeBinaryStream& operator <<(const char* data) {
 		buffer_.write(data, std::strlen(data));
 		return *this;
 	}
@@ -58,22 +89,37 @@ public:
 	/**  Deserialisation **/
 
 	// terminates when it hits a null-byte or consumes all data in the buffer
-	SafeBinaryStream& operator >>(std::string& dest) {
+	BasicSafeBinaryStream& operator >>(std::string& dest) {
 		check_read_bounds(1);
-		char byte;
+		const std::size_t terminator = buffer_.find_first_of('\0', buffer_.size());
+		const std::size_t length = terminator == Buffer::npos? buffer_.size() : terminator;
+		read_string(dest, length, terminator != Buffer::npos);
+		return *this;
+	}
 
-		do { // not overly efficient
-			buffer_.read(&byte, 1);
-			if(byte) {
-				dest.push_back(byte);
+	/*
+	 * Reads a null-terminated string of no more than max_length characters, excluding
+	 * the terminator. Unlike the stream operator, a missing terminator is an error and
+	 * no more than max_length + 1 bytes will be scanned in search of it.
+	 */
+	void get_string(std::string& dest, std::size_t max_length) {
+		// max_length may be npos, so only add one for the terminator when it can't wrap
+		const std::size_t scan_len = buffer_.size() > max_length? max_length + 1 : buffer_.size();
+		const std::size_t terminator = buffer_.find_first_of('\0', scan_len);
+
+		if(terminator == Buffer::npos) {
+			if(scan_len > max_length) {
+				throw stream_read_limit(max_length);
 			}
-		} while(byte && buffer_.size() > 0);
-		
-		return *this;
+
+			throw buffer_underrun(scan_len + 1, buffer_.size());
+		}
+
+		read_string(dest, terminator, true);
 	}
 
 	template<typename T>
-	SafeBinaryStream& operator >>(T& data) {
+	BasicSafeBinaryStream& operator >>(T& data) {
 		static_assert(std::is_trivially_copyable<T>::value, "Cannot safely copy this type");
 		check_read_bounds(sizeof(T));
 		buffer_.read(reinterpret_cast<char*>(&data), sizeof(T));
@@ -91,6 +137,31 @@ public:
 		buffer_.read(dest, size);
 	}
 
+	/*
+	 * Consumes 'length' bytes and returns a pointer to them without copying if
+	 * they're contiguous within the buffer, otherwise they're linearised into
+	 * storage owned by the stream. The pointer is only valid until the next
+	 * operation on the stream or the underlying buffer.
+	 */
+	const char* view(std::size_t length) {
+		check_read_bounds(length);
+		const char* data = buffer_.contiguous_data(length);
+
+		if(!data) {
+			char* linear = linear_storage(length);
+			buffer_.copy(linear, length);
+			data = linear;
+		}
+
+		buffer_.skip(length);
+		return data;
+	}
+
+	// returns nullptr if the next 'length' bytes are not contiguous, does not consume
+	const char* peek_contiguous(std::size_t length) const {
+		return buffer_.contiguous_data(length);
+	}
+
 	/**  Misc functions **/ 
 
 	std::size_t size() const {
@@ -108,6 +179,12 @@ public:
 	bool empty() {
 		return buffer_.empty();
 	}
+
+	BufferType& buffer() {
+		return buffer_;
+	}
 };
 
+typedef BasicSafeBinaryStream<Buffer> SafeBinaryStream;
+
 }} // spark, ember
\ No newline at end of file
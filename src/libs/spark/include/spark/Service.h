@@ -9,27 +9,51 @@
 #pragma once
 
 #include <spark/Common.h>
+#include <spark/BuilderPool.h>
 #include <spark/ServiceDiscovery.h>
 #include <spark/HeartbeatService.h>
 #include <spark/TrackingService.h>
 #include <spark/ServicesMap.h>
 #include <spark/EventDispatcher.h>
 #include <spark/Link.h>
+#include <spark/Hedging.h>
 #include <spark/SessionManager.h>
 #include <spark/NetworkSession.h>
 #include <spark/Listener.h>
 #include <logger/Logger.h>
 #include <boost/asio.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/optional.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <flatbuffers/flatbuffers.h>
+#include <array>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
 #include <cstdint>
 
 namespace ember { namespace spark {
 
 class Service final {
 	typedef std::shared_ptr<flatbuffers::FlatBufferBuilder> BufferHandler;
+	typedef std::function<BufferHandler(const boost::uuids::uuid& id)> RequestBuilder;
+	typedef boost::asio::basic_waitable_timer<std::chrono::steady_clock> SteadyTimer;
+
+	static const std::size_t MAX_BATCH_BYTES = 1024 * 64; // 64KB
+
+	struct PendingBatch {
+		Link link;
+		std::vector<BufferHandler> messages;
+		std::size_t bytes;
+		std::unique_ptr<SteadyTimer> timer;
+	};
+
+	struct HedgedRequest;
 
 	boost::asio::io_service& service_;
 	boost::asio::signal_set signals_;
@@ -41,18 +65,45 @@ class Service final {
 	HeartbeatService hb_service_;
 	TrackingService track_service_;
 	Listener listener_;
+	std::size_t link_stripes_;
+	const std::string host_;
+	bool shared_memory_;
+	Trust trust_;
+	std::array<messaging::Priority, static_cast<std::size_t>(messaging::Service::MAX) + 1> priorities_;
+
+	std::unordered_map<boost::uuids::uuid, PendingBatch, boost::hash<boost::uuids::uuid>> batches_;
+	std::chrono::microseconds batch_window_;
+	std::size_t batch_limit_;
+	std::mutex batch_lock_;
+
+	std::array<LatencyWindow, static_cast<std::size_t>(messaging::Service::MAX) + 1> latencies_;
+	RetryBudget retry_budget_;
 
 	log::Logger* logger_;
 	log::Filter filter_;
 	
 	void do_connect(const std::string& host, std::uint16_t port);
-	void start_session(boost::asio::ip::tcp::socket socket);
+	void do_connect_local(const std::string& path, std::function<void()> fallback);
+	void start_session(boost::asio::generic::stream_protocol::socket socket,
+	                   std::unique_ptr<SharedChannel> channel = nullptr);
 	void default_handler(const Link& link, const messaging::MessageRoot* message);
 	void default_link_state_handler(const Link& link, LinkState state);
 	void initiate_handshake(NetworkSession* session);
+	std::shared_ptr<NetworkSession> session(const Link& link) const;
+	messaging::Priority priority(const flatbuffers::FlatBufferBuilder& fbb) const;
+	void fail_dropped(const std::vector<BufferHandler>& dropped);
+	static Result to_result(WriteResult result);
+	bool queue_batched(const Link& link, BufferHandler fbb);
+	void flush_batch(const Link& link, std::vector<BufferHandler> messages);
+	void batch_expired(const boost::uuids::uuid& link, const boost::system::error_code& ec);
+	Result send_attempt(const std::shared_ptr<HedgedRequest>& request);
+	void schedule_hedge(const std::shared_ptr<HedgedRequest>& request);
+	void hedge_expired(const std::shared_ptr<HedgedRequest>& request, const boost::system::error_code& ec);
+	void attempt_complete(const std::shared_ptr<HedgedRequest>& request, const Link& link,
+	                      const boost::uuids::uuid& id, boost::optional<const messaging::MessageRoot*> root);
 
 public:
-	enum class Result { OK, LINK_GONE };
+	enum class Result { OK, LINK_GONE, BACKPRESSURE, TOO_LARGE };
 
 	Service(std::string description, boost::asio::io_service& service, const std::string& interface,
 	        std::uint16_t port, log::Logger* logger, log::Filter filter);
@@ -60,9 +111,30 @@ public:
 
 	EventDispatcher* dispatcher();
 	void connect(const std::string& host, std::uint16_t port);
+	void connect(const messaging::multicast::LocateAnswer* answer);
+	void connect_local(const std::string& path);
+	void listen_local(const std::string& path);
+	void shared_memory(bool enabled);
+	void trust(Trust trust);
+	void link_stripes(std::size_t count, ServicesMap::Balancing balancing);
+	void default_priority(messaging::Service service, messaging::Priority priority);
+	LaneDepths lane_depths();
+	void water_marks(const WaterMarks& marks);
+	void flush_limits(const FlushLimits& limits);
+	bool congested(const Link& link) const;
+	boost::optional<Link> route(messaging::Service service, std::uint64_t key) const;
 	Result send(const Link& link, BufferHandler fbb) const;
-	Result send_tracked(const Link& link, boost::uuids::uuid id,
-	                    BufferHandler fbb, TrackingHandler callback);
+	Result send_tracked(const Link& link, boost::uuids::uuid id, BufferHandler fbb,
+	                    TrackingHandler callback, Overflow overflow = Overflow::FAIL_FAST,
+	                    std::chrono::milliseconds timeout = std::chrono::seconds(5));
+	Result send_batched(const Link& link, BufferHandler fbb);
+	Result send_tracked_batch(const Link& link, boost::uuids::uuid id, BufferHandler fbb,
+	                          TrackingHandler callback,
+	                          std::chrono::milliseconds timeout = std::chrono::seconds(5));
+	Result send_hedged(messaging::Service service, std::uint64_t key, RequestBuilder builder,
+	                   TrackingHandler callback, const RequestPolicy& policy);
+	void retry_budget(double ratio, double reserve);
+	void batching(std::chrono::microseconds window, std::size_t max_messages);
 	void broadcast(messaging::Service service, ServicesMap::Mode mode, BufferHandler fbb) const;
 	void set_tracking_data(const messaging::MessageRoot* root, messaging::MessageRootBuilder& mrb,
 	                       flatbuffers::FlatBufferBuilder* fbb);
@@ -20,6 +20,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include <cstdint>
@@ -32,6 +33,8 @@ class ServiceDiscovery {
 
 	std::string address_;
 	std::uint16_t port_;
+	const std::string host_;
+	std::string local_path_;
 	boost::asio::io_service& service_;
 	boost::asio::ip::udp::socket socket_;
 	boost::asio::ip::udp::endpoint endpoint_, remote_ep_;
@@ -65,6 +68,7 @@ public:
 					 const std::string& mcast_iface, const std::string& mcast_group,
 	                 std::uint16_t mcast_port, log::Logger* logger, log::Filter filter);
 
+	void announce_local(std::string path);
 	void register_service(messaging::Service service);
 	void remove_service(messaging::Service service);
 	std::unique_ptr<ServiceListener> listener(messaging::Service service, LocateCallback cb);
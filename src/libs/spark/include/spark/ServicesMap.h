@@ -10,23 +10,57 @@
 
 #include <spark/Link.h>
 #include <spark/temp/ServiceTypes_generated.h>
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid.hpp>
 #include <forward_list>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
 
 namespace ember { namespace spark {
 
+class NetworkSession;
+
+/*
+ * A peer may be reached over several connections (stripes) at once. Services
+ * are only registered for a peer's first stripe, while sends are spread across
+ * all of its stripes by select_stripe.
+ *
+ * Requests that should land on the same peer each time, such as those for one
+ * account, use rank_services, which orders peers by rendezvous hashing. A key
+ * only moves to another peer when its own first choice leaves, and keys only
+ * move to a peer that joins if it has become their first choice.
+ */
 class ServicesMap {
+public:
+	enum class Mode { CLIENT, SERVER };
+	enum class Balancing { ROUND_ROBIN, LEAST_OUTSTANDING };
+
+private:
+	struct Stripes {
+		std::vector<std::weak_ptr<NetworkSession>> sessions;
+		std::size_t next = 0;
+	};
+
 	std::unordered_map<messaging::Service, std::forward_list<Link>> peer_servers_;
 	std::unordered_map<messaging::Service, std::forward_list<Link>> peer_clients_;
+	mutable std::unordered_map<boost::uuids::uuid, Stripes, boost::hash<boost::uuids::uuid>> stripes_;
+	Balancing balancing_ = Balancing::LEAST_OUTSTANDING;
 	mutable std::mutex lock_;
 
 public:
-	enum class Mode { CLIENT, SERVER };
-
 	std::vector<Link> peer_services(messaging::Service service, Mode type) const;
+	std::vector<Link> rank_services(messaging::Service service, Mode type, std::uint64_t key) const;
 	void register_peer_service(const Link& link, messaging::Service service, Mode type);
 	void remove_peer(const Link& link);
+
+	bool add_stripe(const Link& link);
+	bool remove_stripe(const Link& link);
+	std::shared_ptr<NetworkSession> select_stripe(const Link& link) const;
+	void balancing(Balancing balancing);
 };
 
-}} // spark, ember
\ No newline at end of file
+}} // spark, ember
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <spark/Common.h>
+#include <boost/optional.hpp>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -20,12 +22,19 @@ class NetworkSession;
 class SessionManager {
 	std::set<std::shared_ptr<NetworkSession>> sessions_;
 	std::mutex sessions_lock_;
+	boost::optional<WaterMarks> water_marks_;
+	boost::optional<FlushLimits> flush_limits_;
+
+	std::set<std::shared_ptr<NetworkSession>> snapshot();
 
 public:
 	void start(std::shared_ptr<NetworkSession> session);
 	void stop(std::shared_ptr<NetworkSession> session);
 	void stop_all();
 	std::size_t count() const;
+	LaneDepths lane_depths();
+	void water_marks(const WaterMarks& marks);
+	void flush_limits(const FlushLimits& limits);
 };
 
 }} // spark, ember
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <spark/SharedRing.h>
+#include <boost/asio.hpp>
+#include <functional>
+#include <memory>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+/*
+ * A pair of shared memory rings between two processes on the same host, one
+ * for each direction, along with an eventfd for each side to be woken by.
+ *
+ * The connecting side creates the channel and hands it to the accepting side
+ * over their local socket, which remains open to detect the other side going
+ * away. Only supported on Linux - elsewhere, the socket is used as normal.
+ */
+class SharedChannel {
+	struct Handles;
+
+	SharedRing inbound_;
+	SharedRing outbound_;
+	std::unique_ptr<Handles> handles_;
+
+	SharedChannel(std::unique_ptr<Handles> handles, bool creator);
+
+public:
+	static const std::size_t RING_CAPACITY = 1024 * 1024 * 4; // 4MB in each direction
+
+	static std::unique_ptr<SharedChannel> create(boost::asio::io_service& service);
+
+	/*
+	 * Every local connection begins with a handshake from the connecting side,
+	 * which either carries a channel or indicates that the socket is to be used.
+	 */
+	static bool send_handshake(int socket, const SharedChannel* channel);
+	static bool receive_handshake(boost::asio::io_service& service, int socket,
+	                              std::unique_ptr<SharedChannel>& channel);
+
+	SharedRing& inbound();
+	SharedRing& outbound();
+
+	// only one wait may be in progress at a time
+	void async_wait(std::function<void(boost::system::error_code)> handler);
+	void notify();
+	void close();
+
+	~SharedChannel();
+};
+
+}} // spark, ember
\ No newline at end of file
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ember { namespace spark {
+
+/*
+ * Single producer, single consumer queue of messages in memory shared between
+ * two processes. Each message is stored contiguously, preceded by its length,
+ * so it can be copied out in one go. A message that won't fit before the end of
+ * the ring is preceded by padding and written at the start instead.
+ *
+ * The waiting flags allow either side to ask to be woken when the other makes
+ * progress, so that no notification is needed while both sides are busy.
+ */
+class SharedRing {
+	typedef std::uint64_t FrameHeader; // length in the low 32 bits
+	static const std::size_t ALIGNMENT = sizeof(FrameHeader);
+	static const std::uint32_t PADDING = 0xFFFFFFFF;
+
+	struct Header {
+		alignas(64) std::atomic<std::uint64_t> head;
+		alignas(64) std::atomic<std::uint64_t> tail;
+		alignas(64) std::atomic<std::uint32_t> consumer_waiting;
+		alignas(64) std::atomic<std::uint32_t> producer_waiting;
+	};
+
+	Header* header_;
+	std::uint8_t* data_;
+	std::size_t capacity_;
+
+	static std::size_t frame_size(std::size_t size) {
+		return (sizeof(FrameHeader) + size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	}
+
+	void write_header(std::size_t offset, std::uint32_t length) {
+		const FrameHeader header = length;
+		std::memcpy(data_ + offset, &header, sizeof(header));
+	}
+
+	std::uint32_t read_header(std::size_t offset) const {
+		FrameHeader header;
+		std::memcpy(&header, data_ + offset, sizeof(header));
+		return static_cast<std::uint32_t>(header);
+	}
+
+public:
+	// capacity must be a power of two
+	SharedRing(void* region, std::size_t capacity)
+	           : header_(static_cast<Header*>(region)),
+	             data_(static_cast<std::uint8_t*>(region) + sizeof(Header)), capacity_(capacity) { }
+
+	static constexpr std::size_t region_size(std::size_t capacity) {
+		return sizeof(Header) + capacity;
+	}
+
+	// only called by the side that creates the shared region
+	void initialise() {
+		new (header_) Header();
+	}
+
+	// the largest message that's guaranteed to fit once the ring has drained
+	std::size_t max_message_size() const {
+		return capacity_ / 2 - sizeof(FrameHeader);
+	}
+
+	bool write(const void* data, std::size_t size) {
+		const std::size_t frame = frame_size(size);
+		std::uint64_t head = header_->head.load(std::memory_order_relaxed);
+		const std::uint64_t tail = header_->tail.load(std::memory_order_acquire);
+		std::size_t offset = head & (capacity_ - 1);
+		const std::size_t contiguous = capacity_ - offset;
+		const std::size_t required = frame > contiguous? frame + contiguous : frame;
+
+		if(size > max_message_size() || capacity_ - (head - tail) < required) {
+			return false;
+		}
+
+		if(frame > contiguous) {
+			write_header(offset, PADDING);
+			head += contiguous;
+			offset = 0;
+		}
+
+		write_header(offset, static_cast<std::uint32_t>(size));
+		std::memcpy(data_ + offset + sizeof(FrameHeader), data, size);
+		header_->head.store(head + frame, std::memory_order_release);
+		return true;
+	}
+
+	/*
+	 * Retrieves the message at the front of the ring without removing it. The
+	 * data is null if the message is malformed, as the other side of the ring
+	 * can't be trusted not to have corrupted it.
+	 */
+	bool peek(const std::uint8_t*& data, std::size_t& size) {
+		std::uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+		const std::uint64_t head = header_->head.load(std::memory_order_acquire);
+
+		while(tail != head) {
+			if(head - tail > capacity_) {
+				data = nullptr;
+				size = 0;
+				return true;
+			}
+
+			const std::size_t offset = tail & (capacity_ - 1);
+			const std::uint32_t length = read_header(offset);
+
+			if(length == PADDING) {
+				tail += capacity_ - offset;
+				header_->tail.store(tail, std::memory_order_release);
+				continue;
+			}
+
+			const bool valid = length <= max_message_size() && offset + frame_size(length) <= capacity_;
+			data = valid? data_ + offset + sizeof(FrameHeader) : nullptr;
+			size = length;
+			return true;
+		}
+
+		return false;
+	}
+
+	void pop(std::size_t size) {
+		const std::uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+		header_->tail.store(tail + frame_size(size), std::memory_order_release);
+	}
+
+	bool empty() const {
+		return header_->head.load() == header_->tail.load();
+	}
+
+	/*
+	 * Called by the consumer before it waits for a notification. Returns false
+	 * if a message arrived in the meantime, in which case it shouldn't wait.
+	 */
+	bool consumer_wait() {
+		header_->consumer_waiting.store(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(!empty()) {
+			header_->consumer_waiting.store(0);
+			return false;
+		}
+
+		return true;
+	}
+
+	// called by the producer when the ring is full, before retrying the write
+	void producer_wait() {
+		header_->producer_waiting.store(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	// whether the other side needs to be notified after writing or consuming
+	bool wake_consumer() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return header_->consumer_waiting.load() && header_->consumer_waiting.exchange(0);
+	}
+
+	bool wake_producer() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return header_->producer_waiting.load() && header_->producer_waiting.exchange(0);
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
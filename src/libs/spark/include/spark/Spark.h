@@ -10,4 +10,5 @@
 
 #include <spark/Service.h>
 #include <spark/buffers/ChainedBuffer.h>
-#include <spark/BinaryStream.h>
\ No newline at end of file
+#include <spark/BinaryStream.h>
+#include <spark/Utility.h>
\ No newline at end of file
@@ -16,33 +16,57 @@
 #include <boost/asio.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/uuid/uuid.hpp>
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <memory>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
 
 namespace ember { namespace spark {
 
+/*
+ * Timeouts are driven by a hashed timing wheel rather than a timer per request.
+ * Each tick expires the requests in one wheel slot, with requests that are due
+ * beyond a full revolution of the wheel staying put until their tick comes up.
+ * Completed requests are lazily removed from the wheel as it turns.
+ *
+ * Pending requests are sharded by their tracking ID, with each shard owning its
+ * slice of the wheel, so replies and registrations only contend with others that
+ * land on the same shard.
+ */
 class TrackingService : public EventHandler {
-	struct Request {
-		Request(boost::asio::io_service& service, boost::uuids::uuid id, Link link, TrackingHandler handler)
-		        : timer(service), id(id), handler(handler), link(std::move(link)) { }
+	static const std::size_t SHARD_COUNT = 16;
+	static const std::size_t WHEEL_SLOTS = 128;
+	static constexpr std::chrono::milliseconds TICK { 50 };
 
-		boost::asio::basic_waitable_timer<std::chrono::steady_clock> timer;
+	struct Request {
 		boost::uuids::uuid id;
 		TrackingHandler handler;
-		const Link link;
+		Link link;
+		std::uint64_t expiry; // tick
+	};
+
+	struct Shard {
+		std::unordered_map<boost::uuids::uuid, Request, boost::hash<boost::uuids::uuid>> requests;
+		std::array<std::vector<boost::uuids::uuid>, WHEEL_SLOTS> wheel;
+		std::mutex lock;
 	};
 
-	std::unordered_map<boost::uuids::uuid, std::unique_ptr<Request>,
-	                   boost::hash<boost::uuids::uuid>> handlers_;
+	std::array<Shard, SHARD_COUNT> shards_;
+	std::atomic<std::uint64_t> tick_;
+	boost::asio::basic_waitable_timer<std::chrono::steady_clock> timer_;
 
 	boost::asio::io_service& service_;
 	log::Logger* logger_;
 	log::Filter filter_;
-	std::mutex lock_;
 
-	void timeout(boost::uuids::uuid id, Link link, const boost::system::error_code& ec);
+	Shard& shard(const boost::uuids::uuid& id);
+	void set_timer();
+	void expire(const boost::system::error_code& ec);
+	boost::optional<Request> release(const boost::uuids::uuid& id);
 
 public:
 	TrackingService(boost::asio::io_service& service, log::Logger* logger, log::Filter filter);
@@ -51,6 +75,8 @@ public:
 	void handle_link_event(const Link& link, LinkState state);
 	void register_tracked(const Link& link, boost::uuids::uuid id, TrackingHandler handler,
 	                      std::chrono::milliseconds timeout);
+	void remove_tracked(const boost::uuids::uuid& id);
+	void fail_tracked(const boost::uuids::uuid& id);
 	void shutdown();
 };
 
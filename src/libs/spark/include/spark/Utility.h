@@ -8,11 +8,23 @@
 
 #pragma once
 
+#include <spark/Common.h>
 #include <spark/temp/ServiceTypes_generated.h>
+#include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
-namespace ember { namespace spark { namespace detail {
+namespace ember { namespace spark {
+
+Trust trust_string(const std::string& trust);
+
+// for rank_services - unlike std::hash, the result is the same on every build and platform
+std::uint64_t routing_key(const std::string& key);
+
+namespace detail {
+
+std::uint64_t fnv1a(const std::uint8_t* data, std::size_t length);
 
 typedef std::underlying_type<messaging::Service>::type ServicesType;
 
@@ -6,25 +6,28 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#pragma once
+
+#include <spark/buffers/ChainedBuffer.h>
 #include <boost/asio/buffer.hpp>
 #include <utility>
 #include <cstddef>
 
 namespace ember { namespace spark {
 
-template<typename std::size_t BlockSize>
-class ChainedBuffer;
-
-template<typename std::size_t BlockSize>
+template<std::size_t BlockSize,
+         typename Allocator = TLSBlockAllocator<BufferBlock<BlockSize>>>
 class BufferSequence {
-	const ChainedBuffer<BlockSize>* chain_;
+	typedef ChainedBuffer<BlockSize, Allocator> ChainType;
+
+	const ChainType* chain_;
 
 public:
-	BufferSequence(const ChainedBuffer<BlockSize>& chain) : chain_(&chain) { }
+	BufferSequence(const ChainType& chain) : chain_(&chain) { }
 
 class const_iterator {
 public:
-	const_iterator(const ChainedBuffer<BlockSize>* chain, const ChainedNode* curr_node)
+	const_iterator(const ChainType* chain, const ChainedNode* curr_node)
 		: chain_(chain), curr_node_(curr_node) {}
 
 	const_iterator& operator++() {
@@ -61,7 +64,7 @@ public:
 #endif
 
 private:
-	const ChainedBuffer<BlockSize>* chain_;
+	const ChainType* chain_;
 	const ChainedNode* curr_node_;
 };
 
@@ -9,22 +9,32 @@
 #pragma once
 
 #include <spark/buffers/ChainedNode.h>
+#include <spark/buffers/ChainedIterator.h>
+#include <spark/buffers/ChainedSegments.h>
+#include <spark/buffers/allocators/TLSBlockAllocator.h>
 #include <spark/Buffer.h>
 #include <boost/assert.hpp>
 #include <algorithm>
-#include <vector>
 #include <utility>
 #include <cstddef>
+#include <cstring>
 
 namespace ember { namespace spark {
 
-template<typename std::size_t BlockSize>
+template<std::size_t BlockSize, typename Allocator>
 class BufferSequence;
 
-template<typename std::size_t BlockSize>
+template<std::size_t BlockSize, typename Allocator>
+class MutableBufferSequence;
+
+template<std::size_t BlockSize,
+         typename Allocator = TLSBlockAllocator<BufferBlock<BlockSize>>>
 class ChainedBuffer final : public Buffer {
+	typedef BufferBlock<BlockSize> BlockType;
+
 	ChainedNode root_;
 	std::size_t size_;
+	Allocator allocator_;
 
 	void link_tail_node(ChainedNode* node) {
 		node->next = &root_;
@@ -47,6 +57,40 @@ class ChainedBuffer final : public Buffer {
 			- offsetof(BufferBlock<BlockSize>, node));
 	}
 
+	// finds the block holding the byte at index, which is updated to its offset in that block
+	BufferBlock<BlockSize>* block_at(std::size_t& index) const {
+		auto head = root_.next;
+		auto buffer = buffer_from_node(head);
+
+		// blocks aren't necessarily full, so they're walked by their actual size
+		while(index >= buffer->size() && head->next != &root_) {
+			index -= buffer->size();
+			head = head->next;
+			buffer = buffer_from_node(head);
+		}
+
+		index += buffer->read_offset;
+		return buffer;
+	}
+
+	/*
+	 * Finds the first block that can accept more data. Only the tail and any
+	 * empty blocks that have been attached behind it by prepare() can be written to.
+	 */
+	ChainedNode* first_writable_node() const {
+		auto node = root_.prev;
+
+		while(node != &root_ && !buffer_from_node(node)->write_offset) {
+			node = node->prev;
+		}
+
+		if(node == &root_) {
+			return root_.next;
+		}
+
+		return buffer_from_node(node)->free()? node : node->next;
+	}
+
 	void move(ChainedBuffer& rhs) {
 		if(this == &rhs) { // self-assignment
 			return;
@@ -79,19 +123,10 @@ class ChainedBuffer final : public Buffer {
 		}
 	}
 	
-	void offset_buffers(std::vector<BufferBlock<BlockSize>*>& buffers, std::size_t offset) {
-		buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [&](BufferBlock<BlockSize>* block) {
-			if(block->size() > offset) {
-				block->read_offset += offset;
-				block->write_offset -= offset;
-				return false;
-			} else {
-				return true;
-			}
-		}), buffers.end());
-	}
-
 public:
+	typedef ChainedIterator<BlockSize, false> iterator;
+	typedef ChainedIterator<BlockSize, true> const_iterator;
+
 	ChainedBuffer() { // todo - change in VS2015
 		root_.next = &root_;
 		root_.prev = &root_;
@@ -110,6 +145,16 @@ public:
 
 	void read(void* destination, std::size_t length) override {
 		BOOST_ASSERT_MSG(length <= size_, "Chained buffer read too large!");
+		auto head = buffer_from_node(root_.next);
+
+		// fast path for small reads that don't exhaust the head block
+		if(root_.next != &root_ && head->read_offset + length < head->write_offset) {
+			std::memcpy(destination, head->read_data(), length);
+			head->read_offset += length;
+			size_ -= length;
+			return;
+		}
+
 		std::size_t remaining = length;
 
 		while(remaining) {
@@ -141,31 +186,16 @@ public:
 		}
 	}
 
-	std::vector<BufferBlock<BlockSize>*> fetch_buffers(std::size_t length, std::size_t offset = 0) {
-		std::size_t total = length + offset;
-		BOOST_ASSERT_MSG(total <= size_, "Chained buffer fetch too large!");
-		std::vector<BufferBlock<BlockSize>*> buffers;
-		auto head = root_.next;
-
-		while(total) {
-			auto buffer = buffer_from_node(head);
-			std::size_t read_size = BlockSize - buffer->read_offset;
-			
-			// guard against overflow - buffer may have more content than requested
-			if(read_size > total) {
-				read_size = total;
-			}
-		
-			buffers.emplace_back(buffer);
-			total -= read_size;
-			head = head->next;
-		}
-
-		if(offset) {
-			offset_buffers(buffers, offset);
-		}
+	// returns a non-owning view of 'length' bytes starting at 'offset', one segment per block
+	ChainedSegments<BlockSize> fetch_buffers(std::size_t length, std::size_t offset = 0) {
+		BOOST_ASSERT_MSG(length + offset <= size_, "Chained buffer fetch too large!");
+		return ChainedSegments<BlockSize>(&root_, root_.next, offset, length);
+	}
 
-		return buffers;
+	// as above, but read-only
+	ChainedSegments<BlockSize, true> fetch_buffers(std::size_t length, std::size_t offset = 0) const {
+		BOOST_ASSERT_MSG(length + offset <= size_, "Chained buffer fetch too large!");
+		return ChainedSegments<BlockSize, true>(&root_, root_.next, offset, length);
 	}
 
 	void skip(std::size_t length) override {
@@ -186,9 +216,19 @@ public:
 	}
 
 	void write(const void* source, std::size_t length) override {
-		std::size_t remaining = length;
 		ChainedNode* tail = root_.prev;
 
+		// fast path for small writes that fit into the tail block
+		if(tail != &root_ && buffer_from_node(tail)->free() >= length) {
+			auto buffer = buffer_from_node(tail);
+			std::memcpy(buffer->write_data(), source, length);
+			buffer->write_offset += length;
+			size_ += length;
+			return;
+		}
+
+		std::size_t remaining = length;
+
 		while(remaining) {
 			BufferBlock<BlockSize>* buffer;
 
@@ -254,11 +294,11 @@ public:
 	}
 
 	BufferBlock<BlockSize>* allocate() const {
-		return new BufferBlock<BlockSize>(); // todo, actual allocator
+		return allocator_.allocate();
 	}
 
 	void deallocate(BufferBlock<BlockSize>* buffer) const {
-		delete buffer; // todo, actual allocator
+		allocator_.deallocate(buffer);
 	}
 
 	void advance_write_cursor(std::size_t size) {
@@ -269,6 +309,45 @@ public:
 		size_ += size;
 	}
 
+	/*
+	 * Attaches empty blocks to the tail of the chain so that the given number
+	 * of blocks are available for scatter reads. Blocks that aren't filled
+	 * are released by commit(), which must be called before any further writes.
+	 */
+	void prepare(std::size_t blocks) {
+		auto node = first_writable_node();
+		std::size_t writable = 0;
+
+		for(; node != &root_; node = node->next) {
+			++writable;
+		}
+
+		for(; writable < blocks; ++writable) {
+			link_tail_node(&allocate()->node);
+		}
+	}
+
+	// advances the write cursor across the blocks attached by prepare()
+	void commit(std::size_t size) {
+		std::size_t remaining = size;
+		auto node = first_writable_node();
+
+		while(remaining) {
+			BOOST_ASSERT_MSG(node != &root_, "Attempted to commit more data than was prepared!");
+			remaining -= buffer_from_node(node)->advance_write_cursor(remaining);
+			node = node->next;
+		}
+
+		size_ += size;
+
+		// release any blocks that didn't receive data, always leaving a tail
+		while(root_.prev != root_.next && !buffer_from_node(root_.prev)->write_offset) {
+			auto tail = root_.prev;
+			unlink_node(tail);
+			deallocate(buffer_from_node(tail));
+		}
+	}
+
 	void clear() override {
 		ChainedNode* head;
 
@@ -284,32 +363,87 @@ public:
 		return !size_;
 	}
 	
-	constexpr std::size_t block_size() const {
-		return BlockSize;
+	// searches the first 'length' bytes for the value, one contiguous block at a time
+	std::size_t find_first_of(char value, std::size_t length) const override {
+		std::size_t index = 0;
+		auto head = root_.next;
+
+		while(head != &root_ && index < length) {
+			auto buffer = buffer_from_node(head);
+			const std::size_t scan_len = std::min(buffer->size(), length - index);
+			auto pos = std::memchr(buffer->read_data(), value, scan_len);
+
+			if(pos) {
+				return index + (static_cast<const char*>(pos) - buffer->read_data());
+			}
+
+			index += scan_len;
+			head = head->next;
+		}
+
+		return npos;
 	}
 
-	char& operator[](const std::size_t index) const {
-		BOOST_ASSERT_MSG(index <= size_, "Buffer subscript index out of range");
+	// returns a pointer to the next 'length' bytes if they don't cross a block boundary
+	const char* contiguous_data(std::size_t length) const override {
+		if(length > size_) {
+			return nullptr;
+		}
 
 		auto head = root_.next;
-		auto buffer = buffer_from_node(head);
-		std::size_t offset_index = index + buffer->read_offset;
-		auto node_index = static_cast<std::size_t>(offset_index / BlockSize);
 
-		for(std::size_t i = 0; i < node_index; ++i) {
+		// skip any exhausted blocks at the head of the chain
+		while(head != &root_ && !buffer_from_node(head)->size()) {
 			head = head->next;
 		}
 
-		buffer = buffer_from_node(head);
-		return (*buffer)[offset_index % BlockSize];
+		if(head == &root_) {
+			return nullptr;
+		}
+
+		auto buffer = buffer_from_node(head);
+		return buffer->size() >= length? buffer->read_data() : nullptr;
+	}
+
+	constexpr std::size_t block_size() const {
+		return BlockSize;
+	}
+
+	iterator begin() {
+		return iterator(&root_, root_.next);
+	}
+
+	iterator end() {
+		return iterator(&root_, &root_);
+	}
+
+	const_iterator begin() const {
+		return const_iterator(&root_, root_.next);
+	}
+
+	const_iterator end() const {
+		return const_iterator(&root_, &root_);
+	}
+
+	const char& operator[](const std::size_t index) const {
+		BOOST_ASSERT_MSG(index <= size_, "Buffer subscript index out of range");
+		std::size_t offset = index;
+		const BufferBlock<BlockSize>* buffer = block_at(offset);
+		return (*buffer)[offset];
 	}
 
 	char& operator[](const std::size_t index) override {
-		return const_cast<char&>(static_cast<const ChainedBuffer<BlockSize>&>(*this)[index]);
+		BOOST_ASSERT_MSG(index <= size_, "Buffer subscript index out of range");
+		std::size_t offset = index;
+		auto buffer = block_at(offset);
+		return (*buffer)[offset];
 	}
 
-	template<typename std::size_t T>
+	template<std::size_t, typename>
 	friend class BufferSequence;
+
+	template<std::size_t, typename>
+	friend class MutableBufferSequence;
 };
 
 }} // spark, ember
\ No newline at end of file
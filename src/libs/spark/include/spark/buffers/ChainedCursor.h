@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <spark/buffers/ChainedBuffer.h>
+#include <boost/assert.hpp>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+/*
+ * Index-based access into a ChainedBuffer that remembers where the last lookup
+ * landed, so that accessing bytes in ascending (or nearby) order doesn't need
+ * to walk the chain from the head each time, as ChainedBuffer::operator[] does.
+ *
+ * The cursor is invalidated by the same operations that invalidate iterators.
+ */
+template<std::size_t BlockSize,
+         typename Allocator = TLSBlockAllocator<BufferBlock<BlockSize>>>
+class ChainedCursor {
+	typedef ChainedBuffer<BlockSize, Allocator> ChainType;
+
+	ChainType& chain_;
+	typename ChainType::iterator pos_;
+	std::size_t index_;
+
+public:
+	explicit ChainedCursor(ChainType& chain) : chain_(chain), pos_(chain.begin()), index_(0) { }
+
+	char& operator[](const std::size_t index) {
+		BOOST_ASSERT_MSG(index < chain_.size(), "Cursor index out of range");
+
+		if(index < index_) {
+			// short hops backwards are cheaper than seeking from the head
+			if(index_ - index < BlockSize) {
+				for(; index_ != index; --index_) {
+					--pos_;
+				}
+
+				return *pos_;
+			}
+
+			pos_ = chain_.begin();
+			index_ = 0;
+		}
+
+		pos_ += index - index_;
+		index_ = index;
+		return *pos_;
+	}
+
+	// discards the cached position, use after the front of the chain has been consumed
+	void reset() {
+		pos_ = chain_.begin();
+		index_ = 0;
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
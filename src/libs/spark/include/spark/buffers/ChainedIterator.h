@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <spark/buffers/ChainedNode.h>
+#include <boost/assert.hpp>
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+/*
+ * Byte iterator over the readable contents of a ChainedBuffer. Stepping through
+ * bytes within a block is a simple offset increment and seeking with += moves a
+ * whole block at a time, rather than walking from the head of the chain.
+ *
+ * Iterators are invalidated by any operation that releases or resets blocks
+ * (read, skip, clear). Writing to the chain does not invalidate them.
+ */
+template<std::size_t BlockSize, bool Const>
+class ChainedIterator {
+	typedef typename std::conditional<Const, const ChainedNode, ChainedNode>::type NodeType;
+	typedef typename std::conditional<Const, const BufferBlock<BlockSize>,
+	                                  BufferBlock<BlockSize>>::type BlockType;
+
+	const ChainedNode* root_;
+	NodeType* node_;
+	std::size_t offset_;
+
+	BlockType* block() const {
+		return reinterpret_cast<BlockType*>(std::size_t(node_) - offsetof(BufferBlock<BlockSize>, node));
+	}
+
+	// move to the next block that has readable data, if the current one has been exhausted
+	void skip_exhausted() {
+		while(node_ != root_ && offset_ == block()->write_offset) {
+			node_ = node_->next;
+			offset_ = node_ != root_? block()->read_offset : 0;
+		}
+	}
+
+public:
+	typedef std::bidirectional_iterator_tag iterator_category;
+	typedef char value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef typename std::conditional<Const, const char*, char*>::type pointer;
+	typedef typename std::conditional<Const, const char&, char&>::type reference;
+
+	ChainedIterator(const ChainedNode* root, NodeType* node)
+	                : root_(root), node_(node), offset_(node != root? block()->read_offset : 0) {
+		skip_exhausted();
+	}
+
+	// allow iterator -> const_iterator conversion
+	template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+	ChainedIterator(const ChainedIterator<BlockSize, OtherConst>& rhs)
+	                : root_(rhs.root_), node_(rhs.node_), offset_(rhs.offset_) { }
+
+	reference operator*() const {
+		BOOST_ASSERT_MSG(node_ != root_, "Attempted to dereference end iterator");
+		return *(block()->data() + offset_);
+	}
+
+	pointer operator->() const {
+		return &**this;
+	}
+
+	ChainedIterator& operator++() {
+		++offset_;
+		skip_exhausted();
+		return *this;
+	}
+
+	ChainedIterator operator++(int) {
+		ChainedIterator current(*this);
+		++*this;
+		return current;
+	}
+
+	ChainedIterator& operator--() {
+		if(node_ != root_ && offset_ != block()->read_offset) {
+			--offset_;
+			return *this;
+		}
+
+		do {
+			node_ = node_->prev;
+		} while(node_ != root_ && !block()->size());
+
+		BOOST_ASSERT_MSG(node_ != root_, "Attempted to decrement begin iterator");
+		offset_ = block()->write_offset - 1;
+		return *this;
+	}
+
+	ChainedIterator operator--(int) {
+		ChainedIterator current(*this);
+		--*this;
+		return current;
+	}
+
+	// seeks forward a block at a time rather than byte by byte
+	ChainedIterator& operator+=(std::size_t distance) {
+		while(distance) {
+			BOOST_ASSERT_MSG(node_ != root_, "Attempted to advance iterator past end");
+			const std::size_t available = block()->write_offset - offset_;
+
+			if(distance < available) {
+				offset_ += distance;
+				break;
+			}
+
+			offset_ += available;
+			distance -= available;
+			skip_exhausted();
+		}
+
+		return *this;
+	}
+
+	ChainedIterator operator+(std::size_t distance) const {
+		ChainedIterator it(*this);
+		it += distance;
+		return it;
+	}
+
+	// number of bytes that can be accessed contiguously from the current position
+	std::size_t contiguous() const {
+		return node_ != root_? block()->write_offset - offset_ : 0;
+	}
+
+	bool operator==(const ChainedIterator& rhs) const {
+		return node_ == rhs.node_ && offset_ == rhs.offset_;
+	}
+
+	bool operator!=(const ChainedIterator& rhs) const {
+		return !(*this == rhs);
+	}
+
+	template<std::size_t, bool>
+	friend class ChainedIterator;
+};
+
+}} // spark, ember
\ No newline at end of file
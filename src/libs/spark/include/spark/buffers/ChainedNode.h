@@ -32,7 +32,7 @@ struct BufferBlock {
 	}
 
 	std::size_t write(const char* source, std::size_t length) {
-		std::size_t write_len = BlockSize - write_offset;
+		std::size_t write_len = free();
 
 		if(write_len > length) {
 			write_len = length;
@@ -44,13 +44,13 @@ struct BufferBlock {
 	}
 
 	std::size_t copy(char* destination, std::size_t length) const {
-		std::size_t read_len = BlockSize - read_offset;
+		std::size_t read_len = size();
 
 		if(read_len > length) {
 			read_len = length;
 		}
 
-		std::copy(storage.data() + read_offset, storage.data() + read_offset + read_len, destination);
+		std::copy(read_data(), read_data() + read_len, destination);
 		return read_len;
 	}
 
@@ -66,7 +66,7 @@ struct BufferBlock {
 	}
 
 	std::size_t skip(std::size_t length, bool allow_optimise = false) {
-		std::size_t skip_len = BlockSize - read_offset;
+		std::size_t skip_len = size();
 
 		if(skip_len > length) {
 			skip_len = length;
@@ -82,7 +82,7 @@ struct BufferBlock {
 	}
 
 	std::size_t reserve(std::size_t length) {
-		std::size_t reserve_len = BlockSize - write_offset;
+		std::size_t reserve_len = free();
 
 		if(reserve_len > length) {
 			reserve_len = length;
@@ -111,8 +111,16 @@ struct BufferBlock {
 		return size;
 	}
 
+	const char* data() const {
+		return storage.data();
+	}
+
+	char* data() {
+		return storage.data();
+	}
+
 	const char* read_data() const {
-		return storage.data() + read_offset;
+		return data() + read_offset;
 	}
 
 	char* write_data() {
@@ -120,11 +128,11 @@ struct BufferBlock {
 	}
 
 	char& operator[](const std::size_t index) {
-		return *(storage.data() + index);
+		return *(data() + index);
 	}
 
-	char& operator[](const std::size_t index) const {
-		return *(storage.data() + index);
+	const char& operator[](const std::size_t index) const {
+		return *(data() + index);
 	}
 };
 
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <spark/buffers/ChainedNode.h>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+template<typename CharType>
+struct BasicSegment {
+	CharType* data;
+	std::size_t size;
+};
+
+typedef BasicSegment<char> Segment;
+typedef BasicSegment<const char> ConstSegment;
+
+/*
+ * Non-owning view over a range of a ChainedBuffer's readable data, presented as
+ * one contiguous segment per block. Building and iterating the range does not
+ * allocate or modify the chain.
+ *
+ * The range is invalidated by the same operations that invalidate iterators.
+ */
+template<std::size_t BlockSize, bool Const = false>
+class ChainedSegments {
+	typedef typename std::conditional<Const, const BufferBlock<BlockSize>,
+	                                  BufferBlock<BlockSize>>::type BlockType;
+	typedef typename std::conditional<Const, ConstSegment, Segment>::type SegmentType;
+
+	const ChainedNode* root_;
+	ChainedNode* first_;
+	std::size_t offset_;
+	std::size_t length_;
+
+public:
+	class const_iterator {
+		const ChainedNode* root_;
+		ChainedNode* node_;
+		std::size_t offset_; // offset into the current block's readable data
+		std::size_t remaining_;
+
+		BlockType* block() const {
+			return reinterpret_cast<BlockType*>(std::size_t(node_) - offsetof(BufferBlock<BlockSize>, node));
+		}
+
+		// skip blocks that have nothing to contribute, including empty ones
+		void skip_empty() {
+			while(node_ != root_ && (!remaining_ || block()->size() == offset_)) {
+				node_ = remaining_? node_->next : const_cast<ChainedNode*>(root_);
+				offset_ = 0;
+			}
+		}
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef SegmentType value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const SegmentType* pointer;
+		typedef SegmentType reference;
+
+		const_iterator(const ChainedNode* root, ChainedNode* node, std::size_t offset,
+		               std::size_t remaining)
+		               : root_(root), node_(node), offset_(offset), remaining_(remaining) {
+			skip_empty();
+		}
+
+		SegmentType operator*() const {
+			auto buffer = block();
+			const std::size_t size = std::min(buffer->size() - offset_, remaining_);
+			return { buffer->data() + buffer->read_offset + offset_, size };
+		}
+
+		const_iterator& operator++() {
+			remaining_ -= std::min(block()->size() - offset_, remaining_);
+			node_ = node_->next;
+			offset_ = 0;
+			skip_empty();
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+			const_iterator current(*this);
+			++*this;
+			return current;
+		}
+
+		bool operator==(const const_iterator& rhs) const {
+			return node_ == rhs.node_ && offset_ == rhs.offset_;
+		}
+
+		bool operator!=(const const_iterator& rhs) const {
+			return !(*this == rhs);
+		}
+	};
+
+	ChainedSegments(const ChainedNode* root, ChainedNode* first, std::size_t offset, std::size_t length)
+	                : root_(root), first_(first), offset_(offset), length_(length) { }
+
+	const_iterator begin() const {
+		auto node = first_;
+		std::size_t offset = offset_;
+
+		// locate the block containing the first byte of the range
+		while(node != root_) {
+			auto block = reinterpret_cast<BufferBlock<BlockSize>*>(std::size_t(node)
+				- offsetof(BufferBlock<BlockSize>, node));
+
+			if(offset < block->size()) {
+				break;
+			}
+
+			offset -= block->size();
+			node = node->next;
+		}
+
+		return const_iterator(root_, node, offset, length_);
+	}
+
+	const_iterator end() const {
+		return const_iterator(root_, const_cast<ChainedNode*>(root_), 0, 0);
+	}
+
+	std::size_t size() const {
+		return length_;
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <spark/buffers/ChainedBuffer.h>
+#include <boost/asio/buffer.hpp>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+/*
+ * Exposes the free space at the tail of a chain as a scatter list for
+ * asynchronous reads. Use ChainedBuffer::prepare() to attach blocks beforehand
+ * and ChainedBuffer::commit() to advance the write cursor once the read completes.
+ */
+template<std::size_t BlockSize,
+         typename Allocator = TLSBlockAllocator<BufferBlock<BlockSize>>>
+class MutableBufferSequence {
+	typedef ChainedBuffer<BlockSize, Allocator> ChainType;
+
+	ChainType* chain_;
+
+public:
+	MutableBufferSequence(ChainType& chain) : chain_(&chain) { }
+
+class const_iterator {
+public:
+	const_iterator(const ChainType* chain, ChainedNode* curr_node)
+		: chain_(chain), curr_node_(curr_node) {}
+
+	const_iterator& operator++() {
+		curr_node_ = curr_node_->next;
+		return *this;
+	}
+
+	const_iterator operator++(int) {
+		const_iterator current(*this);
+		curr_node_ = curr_node_->next;
+		return current;
+	}
+
+	boost::asio::mutable_buffer operator*() const {
+		auto buffer = chain_->buffer_from_node(curr_node_);
+		return boost::asio::mutable_buffer(buffer->write_data(), buffer->free());
+	}
+
+	bool operator==(const const_iterator& rhs) const {
+		return curr_node_ == rhs.curr_node_;
+	}
+
+	bool operator!=(const const_iterator& rhs) const {
+		return curr_node_ != rhs.curr_node_;
+	}
+
+private:
+	const ChainType* chain_;
+	ChainedNode* curr_node_;
+};
+
+const_iterator begin() const {
+	return const_iterator(chain_, chain_->first_writable_node());
+}
+
+const_iterator end() const {
+	return const_iterator(chain_, &chain_->root_);
+}
+
+};
+
+}} // spark, ember
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <spark/Buffer.h>
+#include <spark/Exception.h>
+#include <boost/assert.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+namespace ember { namespace spark {
+
+/*
+ * Fixed-capacity buffer with inline storage, intended for serialising small
+ * packets on the stack before they're appended to an outbound chain.
+ * Writing beyond the capacity throws rather than allocating.
+ */
+template<std::size_t Capacity>
+class StaticBuffer final : public Buffer {
+	std::array<char, Capacity> storage_;
+	std::size_t read_offset_ = 0;
+	std::size_t write_offset_ = 0;
+
+	void check_capacity(std::size_t length) const {
+		if(length > free()) {
+			throw buffer_overflow(length, free());
+		}
+	}
+
+public:
+	void read(void* destination, std::size_t length) override {
+		copy(destination, length);
+		skip(length);
+	}
+
+	void copy(void* destination, std::size_t length) const override {
+		BOOST_ASSERT_MSG(length <= size(), "Static buffer copy too large!");
+		std::memcpy(destination, storage_.data() + read_offset_, length);
+	}
+
+	void skip(std::size_t length) override {
+		BOOST_ASSERT_MSG(length <= size(), "Static buffer skip too large!");
+		read_offset_ += length;
+
+		if(read_offset_ == write_offset_) {
+			clear();
+		}
+	}
+
+	void write(const void* source, std::size_t length) override {
+		check_capacity(length);
+		std::memcpy(storage_.data() + write_offset_, source, length);
+		write_offset_ += length;
+	}
+
+	void reserve(std::size_t length) override {
+		check_capacity(length);
+		write_offset_ += length;
+	}
+
+	std::size_t size() const override {
+		return write_offset_ - read_offset_;
+	}
+
+	void clear() override {
+		read_offset_ = 0;
+		write_offset_ = 0;
+	}
+
+	bool empty() override {
+		return read_offset_ == write_offset_;
+	}
+
+	std::size_t find_first_of(char value, std::size_t length) const override {
+		auto pos = std::memchr(data(), value, std::min(length, size()));
+		return pos? static_cast<const char*>(pos) - data() : npos;
+	}
+
+	const char* contiguous_data(std::size_t length) const override {
+		return length <= size()? data() : nullptr;
+	}
+
+	char& operator[](const std::size_t index) override {
+		BOOST_ASSERT_MSG(index < size(), "Buffer subscript index out of range");
+		return storage_[read_offset_ + index];
+	}
+
+	const char* data() const {
+		return storage_.data() + read_offset_;
+	}
+
+	char* data() {
+		return storage_.data() + read_offset_;
+	}
+
+	std::size_t free() const {
+		return Capacity - write_offset_;
+	}
+
+	constexpr std::size_t capacity() const {
+		return Capacity;
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+namespace ember { namespace spark {
+
+/*
+ * Plain new/delete allocator, mostly useful for debugging memory issues
+ * that the pooled allocator might otherwise mask
+ */
+template<typename T>
+class NewAllocator final {
+public:
+	T* allocate() const {
+		return new T();
+	}
+
+	void deallocate(T* t) const {
+		delete t;
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
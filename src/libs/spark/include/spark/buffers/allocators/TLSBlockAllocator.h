@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <new>
+#include <cstddef>
+
+namespace ember { namespace spark {
+
+struct AllocatorStats {
+	std::size_t allocations;   // total calls to allocate()
+	std::size_t deallocations; // total calls to deallocate()
+	std::size_t cache_hits;    // allocations served from the free list
+	std::size_t cached;        // blocks sitting in the free list
+	std::size_t peak_cached;
+	std::size_t released;      // blocks returned to the OS
+};
+
+/*
+ * Per-thread free-list allocator for fixed-size buffer blocks.
+ *
+ * Each thread keeps its own singly linked list of released blocks, so no
+ * locking is required. Blocks may be freed on a different thread to the one that
+ * allocated them, in which case they simply migrate to the freeing thread's cache.
+ * Once a thread's cache reaches MaxCached blocks, any further releases are
+ * returned to the OS rather than cached. Stats are tracked per-thread.
+ */
+template<typename T, std::size_t MaxCached = 256>
+class TLSBlockAllocator final {
+	struct FreeNode {
+		FreeNode* next;
+	};
+
+	static_assert(sizeof(T) >= sizeof(FreeNode), "Type is too small to be pooled");
+
+	struct Cache {
+		FreeNode* head = nullptr;
+		AllocatorStats stats {};
+
+		void release(std::size_t retain) {
+			while(head && stats.cached > retain) {
+				FreeNode* node = head;
+				head = node->next;
+				::operator delete(node);
+				--stats.cached;
+				++stats.released;
+			}
+		}
+
+		~Cache() {
+			release(0);
+		}
+	};
+
+	static Cache& cache() {
+		thread_local Cache cache;
+		return cache;
+	}
+
+public:
+	T* allocate() const {
+		Cache& tls = cache();
+		++tls.stats.allocations;
+		void* memory;
+
+		if(tls.head) {
+			memory = tls.head;
+			tls.head = tls.head->next;
+			--tls.stats.cached;
+			++tls.stats.cache_hits;
+		} else {
+			memory = ::operator new(sizeof(T));
+		}
+
+		return new (memory) T();
+	}
+
+	void deallocate(T* t) const {
+		Cache& tls = cache();
+		++tls.stats.deallocations;
+		t->~T();
+
+		if(tls.stats.cached >= MaxCached) {
+			::operator delete(t);
+			++tls.stats.released;
+			return;
+		}
+
+		auto node = reinterpret_cast<FreeNode*>(t);
+		node->next = tls.head;
+		tls.head = node;
+
+		if(++tls.stats.cached > tls.stats.peak_cached) {
+			tls.stats.peak_cached = tls.stats.cached;
+		}
+	}
+
+	// returns cached blocks to the OS until no more than 'retain' remain
+	static void trim(std::size_t retain = 0) {
+		cache().release(retain);
+	}
+
+	static const AllocatorStats& stats() {
+		return cache().stats;
+	}
+
+	static constexpr std::size_t max_cached() {
+		return MaxCached;
+	}
+};
+
+}} // spark, ember
\ No newline at end of file
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/Compression.h>
+#include <spark/Exception.h>
+#include <algorithm>
+
+namespace ember { namespace spark {
+
+DeflateStream::DeflateStream(int level) : stream_{} {
+	if(deflateInit(&stream_, level) != Z_OK) {
+		throw exception("Unable to initialise deflate stream");
+	}
+}
+
+bool DeflateStream::deflate(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& out) {
+	const std::size_t CHUNK_SIZE = 256;
+	std::size_t written = out.size();
+
+	stream_.next_in = const_cast<Bytef*>(data);
+	stream_.avail_in = static_cast<uInt>(size);
+
+	// keep going until zlib stops filling the output, otherwise the flush may be incomplete
+	do {
+		out.resize(written + std::max(CHUNK_SIZE, size / 2));
+		stream_.next_out = out.data() + written;
+		stream_.avail_out = static_cast<uInt>(out.size() - written);
+
+		const int ret = ::deflate(&stream_, Z_SYNC_FLUSH);
+
+		if(ret != Z_OK && ret != Z_BUF_ERROR) {
+			return false;
+		}
+
+		written = out.size() - stream_.avail_out;
+	} while(stream_.avail_out == 0);
+
+	out.resize(written);
+	return true;
+}
+
+DeflateStream::~DeflateStream() {
+	deflateEnd(&stream_);
+}
+
+InflateStream::InflateStream() : stream_{} {
+	if(inflateInit(&stream_) != Z_OK) {
+		throw exception("Unable to initialise inflate stream");
+	}
+}
+
+bool InflateStream::inflate(const std::uint8_t* data, std::size_t size, std::uint8_t* out, std::size_t out_size) {
+	stream_.next_in = const_cast<Bytef*>(data);
+	stream_.avail_in = static_cast<uInt>(size);
+	stream_.next_out = out;
+	stream_.avail_out = static_cast<uInt>(out_size);
+
+	// the trailing flush marker doesn't produce output, so may need a second pass
+	while(stream_.avail_in) {
+		const auto avail_in = stream_.avail_in;
+		const int ret = ::inflate(&stream_, Z_SYNC_FLUSH);
+
+		if((ret != Z_OK && ret != Z_BUF_ERROR) || stream_.avail_in == avail_in) {
+			return false;
+		}
+	}
+
+	return stream_.avail_out == 0;
+}
+
+InflateStream::~InflateStream() {
+	inflateEnd(&stream_);
+}
+
+}} // spark, ember
\ No newline at end of file
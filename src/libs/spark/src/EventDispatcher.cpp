@@ -7,22 +7,65 @@
  */
 
 #include <spark/EventDispatcher.h>
+#include <thread>
 
 namespace ember { namespace spark {
 
+// the service comes off the wire, so it can't be trusted to be in range
+bool EventDispatcher::in_range(messaging::Service service) {
+	return static_cast<std::size_t>(service) < MAX_SERVICES;
+}
+
+template<typename Func>
+void EventDispatcher::dispatch(messaging::Service service, Func&& func) const {
+	if(!in_range(service)) {
+		return;
+	}
+
+	auto& entry = handlers_[static_cast<std::size_t>(service)];
+	auto& active = entry.active[entry.epoch.load() & 1];
+	++active;
+
+	if(auto handler = entry.handler.load()) {
+		func(handler);
+	}
+
+	--active;
+}
+
+/* Both epochs are retired in turn - a dispatch may have read the epoch just
+   before it was advanced and not yet registered itself against it */
+void EventDispatcher::replace_handler(Slot& slot, EventHandler* handler) {
+	slot.handler.store(handler);
+
+	for(int i = 0; i < 2; ++i) {
+		const auto epoch = slot.epoch.fetch_add(1);
+
+		while(slot.active[epoch & 1].load()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
 void EventDispatcher::register_handler(EventHandler* handler, messaging::Service service, Mode mode) {
-	std::unique_lock<std::shared_timed_mutex> guard(lock_);
-	handlers_[service] = { mode, handler };
+	if(!in_range(service)) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock_);
+	auto& entry = handlers_[static_cast<std::size_t>(service)];
+	entry.mode = mode;
+	replace_handler(entry, handler);
 }
 
 /* Remove by pointer rather than service to reduce the odds of making the
    mistake of removing a handler that doesn't belong to the caller */
 void EventDispatcher::remove_handler(EventHandler* handler) {
-	std::unique_lock<std::shared_timed_mutex> guard(lock_);
+	std::lock_guard<std::mutex> guard(lock_);
 	
-	for(auto& entry: handlers_) {
-		if(entry.second.handler == handler) {
-			handlers_.erase(entry.first);
+	for(auto& entry : handlers_) {
+		if(entry.handler.load() == handler) {
+			replace_handler(entry, nullptr);
 			break;
 		}
 	}
@@ -30,31 +73,27 @@ void EventDispatcher::remove_handler(EventHandler* handler) {
 
 void EventDispatcher::dispatch_link_event(messaging::Service service,
                                           const Link& link, LinkState state) const {
-	std::unique_lock<std::shared_timed_mutex> guard(lock_);
-	auto it = handlers_.find(service);
-
-	if(it != handlers_.end()) {
-		it->second.handler->handle_link_event(link, state);
-	}
+	dispatch(service, [&](EventHandler* handler) {
+		handler->handle_link_event(link, state);
+	});
 }
 
 void EventDispatcher::dispatch_message(messaging::Service service, const Link& link,
                                        const messaging::MessageRoot* message) const {
-	std::unique_lock<std::shared_timed_mutex> guard(lock_);
-	auto it = handlers_.find(service);
-
-	if(it != handlers_.end()) {
-		it->second.handler->handle_message(link, message);
-	}
+	dispatch(service, [&](EventHandler* handler) {
+		handler->handle_message(link, message);
+	});
 } 
 
 std::vector<messaging::Service> EventDispatcher::services(Mode mode) const {
-	std::shared_lock<std::shared_timed_mutex> guard(lock_);
+	std::lock_guard<std::mutex> guard(lock_);
 	std::vector<messaging::Service> services;
 
-	for(auto& handler : handlers_) {
-		if(handler.second.mode == mode || handler.second.mode == Mode::BOTH) {
-			services.emplace_back(handler.first);
+	for(std::size_t i = 0; i < handlers_.size(); ++i) {
+		auto& entry = handlers_[i];
+
+		if(entry.handler.load() && (entry.mode == mode || entry.mode == Mode::BOTH)) {
+			services.emplace_back(static_cast<messaging::Service>(i));
 		}
 	}
 
@@ -8,6 +8,7 @@
 
 #include <spark/HeartbeatService.h>
 #include <spark/Service.h>
+#include <spark/BuilderPool.h>
 #include <spark/temp/Core_generated.h>
 #include <boost/uuid/uuid_io.hpp>
 #include <functional>
@@ -71,7 +72,7 @@ void HeartbeatService::handle_pong(const Link& link, const messaging::MessageRoo
 }
 
 void HeartbeatService::send_ping(const Link& link, std::uint64_t time) {
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = BuilderPool::acquire();
 	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Core, 0, 0,
 		messaging::Data::Ping, messaging::CreatePing(*fbb, time).Union());
 	fbb->Finish(msg);
@@ -79,7 +80,7 @@ void HeartbeatService::send_ping(const Link& link, std::uint64_t time) {
 }
 
 void HeartbeatService::send_pong(const Link& link, std::uint64_t time) {
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = BuilderPool::acquire();
 	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Core, 0, 0,
 		messaging::Data::Pong, messaging::CreatePong(*fbb, time).Union());
 	fbb->Finish(msg);
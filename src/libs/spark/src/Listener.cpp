@@ -9,6 +9,7 @@
 #include <spark/Listener.h>
 #include <spark/NetworkSession.h>
 #include <spark/SessionManager.h>
+#include <cstdio>
 
 namespace ember { namespace spark {
 
@@ -18,7 +19,10 @@ Listener::Listener(boost::asio::io_service& service, std::string interface, std:
                    : service_(service), acceptor_(service, boost::asio::ip::tcp::endpoint(
                      boost::asio::ip::address::from_string(interface), port)), link_(link),
                      socket_(service), sessions_(sessions), logger_(logger), filter_(filter),
-                     handlers_(handlers), services_(services) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+                     local_acceptor_(service), local_socket_(service),
+#endif
+                     handlers_(handlers), services_(services), trust_(Trust::NONE) {
 	acceptor_.set_option(boost::asio::ip::tcp::no_delay(true));
 	acceptor_.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
 	accept_connection();
@@ -46,16 +50,94 @@ void Listener::accept_connection() {
 	});
 }
 
-void Listener::start_session(boost::asio::ip::tcp::socket socket) {
+/*
+ * Also accepts connections on a Unix domain socket at the given path, for
+ * peers running on the same host. Any socket left behind by a previous
+ * instance is replaced.
+ */
+void Listener::listen_local(const std::string& path) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	std::remove(path.c_str());
+	local_acceptor_.open(boost::asio::local::stream_protocol());
+	local_acceptor_.bind(boost::asio::local::stream_protocol::endpoint(path));
+	local_acceptor_.listen();
+	local_path_ = path;
+
+	LOG_DEBUG_FILTER(logger_, filter_)
+		<< "[spark] Accepting local connections on " << path << LOG_ASYNC;
+
+	accept_local_connection();
+#else
+	LOG_WARN_FILTER(logger_, filter_)
+		<< "[spark] Local sockets are not supported on this platform" << LOG_ASYNC;
+#endif
+}
+
+void Listener::accept_local_connection() {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
+
+	local_acceptor_.async_accept(local_socket_, [this](boost::system::error_code ec) {
+		if(!local_acceptor_.is_open()) {
+			return;
+		}
+
+		if(!ec) {
+			LOG_DEBUG_FILTER(logger_, filter_)
+				<< "[spark] Accepted local connection on " << local_path_ << LOG_ASYNC;
+
+			receive_handshake(std::make_shared<boost::asio::local::stream_protocol::socket>(std::move(local_socket_)));
+		}
+
+		accept_local_connection();
+	});
+#endif
+}
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+// the session can't start until the connecting side has said whether it's using shared memory
+void Listener::receive_handshake(std::shared_ptr<boost::asio::local::stream_protocol::socket> socket) {
+	socket->async_read_some(boost::asio::null_buffers(), [this, socket](boost::system::error_code ec, std::size_t) {
+		if(ec || !local_acceptor_.is_open()) {
+			return;
+		}
+
+		std::unique_ptr<SharedChannel> channel;
+
+		if(!SharedChannel::receive_handshake(service_, socket->native_handle(), channel)) {
+			LOG_WARN_FILTER(logger_, filter_)
+				<< "[spark] Invalid handshake on local connection to " << local_path_ << LOG_ASYNC;
+			return;
+		}
+
+		start_session(std::move(*socket), std::move(channel));
+	});
+}
+#endif
+
+void Listener::start_session(boost::asio::generic::stream_protocol::socket socket,
+                             std::unique_ptr<SharedChannel> channel) {
 	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
-	MessageHandler m_handler(handlers_, services_, link_, false, logger_, filter_);
-	auto session = std::make_shared<NetworkSession>(sessions_, std::move(socket), m_handler, logger_, filter_);
+	MessageHandler m_handler(handlers_, services_, link_, false, trust_, logger_, filter_);
+	auto session = std::make_shared<NetworkSession>(sessions_, std::move(socket), m_handler, logger_, filter_,
+	                                                std::move(channel));
 	sessions_.start(session);
 }
 
+void Listener::trust(Trust trust) {
+	trust_ = trust;
+}
+
 void Listener::shutdown() {
 	LOG_DEBUG_FILTER(logger_, filter_) << "[spark] Listener shutting down..." << LOG_ASYNC;
 	acceptor_.close();
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	if(local_acceptor_.is_open()) {
+		local_acceptor_.close();
+		std::remove(local_path_.c_str());
+	}
+#endif
 }
 
 }} // spark, ember
\ No newline at end of file
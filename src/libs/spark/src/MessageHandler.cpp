@@ -7,6 +7,7 @@
  */
 
 #include <spark/MessageHandler.h>
+#include <spark/BuilderPool.h>
 #include <spark/EventDispatcher.h>
 #include <spark/NetworkSession.h>
 #include <spark/Utility.h>
@@ -17,33 +18,180 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <algorithm>
+#include <type_traits>
 
 namespace ember { namespace spark {
 
+namespace {
+
+typedef flatbuffers::uoffset_t uoffset_t;
+typedef flatbuffers::soffset_t soffset_t;
+typedef flatbuffers::voffset_t voffset_t;
+
+/*
+ * Bounds checks used for messages from trusted peers. Offsets are taken from
+ * the start of the buffer and every check is done before anything is read, so
+ * a corrupt offset can't be used to read outside of it.
+ */
+bool in_bounds(std::size_t size, std::size_t offset, std::size_t length) {
+	return offset <= size && length <= size - offset;
+}
+
+// the table's vtable and inline data
+bool verify_table(const std::uint8_t* data, std::size_t size, std::size_t table) {
+	if(!in_bounds(size, table, sizeof(soffset_t))) {
+		return false;
+	}
+
+	// the vtable holds its own size followed by the size of the table
+	const auto vtable = static_cast<std::int64_t>(table) - flatbuffers::ReadScalar<soffset_t>(data + table);
+
+	if(vtable < 0 || !in_bounds(size, static_cast<std::size_t>(vtable), sizeof(voffset_t) * 2)) {
+		return false;
+	}
+
+	const std::size_t vtable_size = flatbuffers::ReadScalar<voffset_t>(data + vtable);
+	const std::size_t table_size = flatbuffers::ReadScalar<voffset_t>(data + vtable + sizeof(voffset_t));
+
+	return vtable_size >= sizeof(voffset_t) * 2 && in_bounds(size, static_cast<std::size_t>(vtable), vtable_size)
+		&& in_bounds(size, table, table_size);
+}
+
+// absent fields pass, as the accessors won't read them
+bool verify_field(const std::uint8_t* data, std::size_t size, std::size_t table,
+                  voffset_t field, std::size_t length) {
+	auto fields = reinterpret_cast<const flatbuffers::Table*>(data + table);
+	const auto offset = fields->GetOptionalFieldOffset(field);
+	return !offset || in_bounds(size, table + offset, length);
+}
+
+// follows an offset field, or an element of a vector of offsets, returning where it leads
+bool follow_offset(const std::uint8_t* data, std::size_t size, std::size_t offset, std::size_t& target) {
+	if(!in_bounds(size, offset, sizeof(uoffset_t))) {
+		return false;
+	}
+
+	target = offset + flatbuffers::ReadScalar<uoffset_t>(data + offset);
+	return target < size;
+}
+
+bool verify_vector(const std::uint8_t* data, std::size_t size, std::size_t vector, std::size_t element_size) {
+	if(!in_bounds(size, vector, sizeof(uoffset_t))) {
+		return false;
+	}
+
+	const std::size_t length = flatbuffers::ReadScalar<uoffset_t>(data + vector);
+	return length <= size / element_size && in_bounds(size, vector + sizeof(uoffset_t), length * element_size);
+}
+
+// a vector field of the table at the given offset, which must already have been verified
+bool verify_vector_field(const std::uint8_t* data, std::size_t size, std::size_t table,
+                         voffset_t field, std::size_t element_size, std::size_t* vector_out = nullptr) {
+	auto fields = reinterpret_cast<const flatbuffers::Table*>(data + table);
+	const auto offset = fields->GetOptionalFieldOffset(field);
+
+	if(!offset) {
+		return true;
+	}
+
+	std::size_t vector;
+
+	if(!follow_offset(data, size, table + offset, vector) || !verify_vector(data, size, vector, element_size)) {
+		return false;
+	}
+
+	if(vector_out) {
+		*vector_out = vector;
+	}
+
+	return true;
+}
+
+/*
+ * Routing reads the service, the tracking fields and the type of the message.
+ * Batches are unpacked as they're routed, so each envelope is checked as far
+ * as its nested message. The nested messages are verified as they're dispatched.
+ */
+bool verify_routing(const std::uint8_t* data, std::size_t size, std::size_t root) {
+	typedef messaging::MessageRoot MR;
+	typedef std::underlying_type<messaging::Service>::type ServiceType;
+	typedef std::underlying_type<messaging::Data>::type DataType;
+
+	if(!verify_field(data, size, root, MR::VT_SERVICE, sizeof(ServiceType))
+	   || !verify_field(data, size, root, MR::VT_TRACKING_TTL, sizeof(std::int8_t))
+	   || !verify_field(data, size, root, MR::VT_DATA_TYPE, sizeof(DataType))
+	   || !verify_vector_field(data, size, root, MR::VT_TRACKING_ID, sizeof(std::uint8_t))) {
+		return false;
+	}
+
+	if(messaging::GetMessageRoot(data)->data_type() != messaging::Data::Batch) {
+		return true;
+	}
+
+	auto fields = reinterpret_cast<const flatbuffers::Table*>(data + root);
+	const auto data_offset = fields->GetOptionalFieldOffset(MR::VT_DATA);
+	std::size_t batch, messages = 0; // left as zero if the batch is empty
+
+	if(!data_offset) {
+		return true;
+	}
+
+	if(!follow_offset(data, size, root + data_offset, batch) || !verify_table(data, size, batch)
+	   || !verify_vector_field(data, size, batch, messaging::Batch::VT_MESSAGES, sizeof(uoffset_t), &messages)) {
+		return false;
+	}
+
+	if(!messages) {
+		return true;
+	}
+
+	const std::size_t count = flatbuffers::ReadScalar<uoffset_t>(data + messages);
+
+	for(std::size_t i = 0; i < count; ++i) {
+		std::size_t envelope;
+		const auto element = messages + sizeof(uoffset_t) + i * sizeof(uoffset_t);
+
+		if(!follow_offset(data, size, element, envelope) || !verify_table(data, size, envelope)
+		   || !verify_vector_field(data, size, envelope, messaging::Envelope::VT_MESSAGE, sizeof(std::uint8_t))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} // unnamed
+
 MessageHandler::MessageHandler(const EventDispatcher& dispatcher, ServicesMap& services, const Link& link,
-                               bool initiator, log::Logger* logger, log::Filter filter)
+                               bool initiator, Trust trust, log::Logger* logger, log::Filter filter)
                                : dispatcher_(dispatcher), self_(link), initiator_(initiator),
+                                 trust_(trust), trusted_(false),
                                  logger_(logger), filter_(filter), services_(services), peer_{} { }
 
 
 void MessageHandler::send_negotiation(NetworkSession& net) {
 	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = BuilderPool::acquire();
 	auto in = fbb->CreateVector(detail::services_to_underlying(dispatcher_.services(EventDispatcher::Mode::SERVER)));
 	auto out = fbb->CreateVector(detail::services_to_underlying(dispatcher_.services(EventDispatcher::Mode::CLIENT)));
 
 	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Core, 0, 0,
-		messaging::Data::Negotiate, messaging::CreateNegotiate(*fbb, in, out).Union());
+		messaging::Data::Negotiate,
+		messaging::CreateNegotiate(*fbb, in, out, messaging::Compression::Zlib, offer_trust(net), true).Union());
 
 	fbb->Finish(msg);
-	net.write(fbb);
+	net.write(fbb, messaging::Priority::Control);
+}
+
+bool MessageHandler::offer_trust(const NetworkSession& net) const {
+	return trust_ == Trust::ALL || (trust_ == Trust::LOCAL && net.local());
 }
 
 void MessageHandler::send_banner(NetworkSession& net) {
 	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = BuilderPool::acquire();
 	auto desc = fbb->CreateString(self_.description);
 	auto uuid = fbb->CreateVector(self_.uuid.begin(), self_.uuid.size());
 
@@ -51,7 +199,7 @@ void MessageHandler::send_banner(NetworkSession& net) {
 		messaging::Data::Banner, messaging::CreateBanner(*fbb, desc, uuid).Union());
 
 	fbb->Finish(msg);
-	net.write(fbb);
+	net.write(fbb, messaging::Priority::Control);
 }
 
 bool MessageHandler::establish_link(NetworkSession& net, const messaging::MessageRoot* message) {
@@ -152,8 +300,29 @@ bool MessageHandler::negotiate_protocols(NetworkSession& net, const messaging::M
 		send_negotiation(net);
 	}
 
+	// our negotiation has been sent, so anything after it can be compressed
+	if(protocols->compression() == messaging::Compression::Zlib) {
+		net.enable_compression(COMPRESSION_THRESHOLD);
+	}
+
+	if(protocols->batching()) {
+		net.enable_batching();
+	}
+
+	// both sides have to agree, so a misconfigured peer can't switch off our verification
+	trusted_ = offer_trust(net) && protocols->trusted();
+	state_ = State::FORWARDING;
+
+	// additional connections to a peer that's already linked just carry traffic
+	if(!services_.add_stripe(peer_)) {
+		LOG_DEBUG_FILTER(logger_, filter_)
+			<< "[spark] Established additional stripe: " << peer_.description << ":"
+			<< boost::uuids::to_string(peer_.uuid) << LOG_ASYNC;
+		return true;
+	}
+
 	LOG_INFO_FILTER(logger_, filter_)
-		<< "[spark] Established link: " << peer_.description << ":"
+		<< "[spark] Established " << (trusted_? "trusted " : "") << "link: " << peer_.description << ":"
 		<< boost::uuids::to_string(peer_.uuid) << LOG_ASYNC;
 
 	// register peer's services to allow for broadcasting
@@ -172,7 +341,6 @@ bool MessageHandler::negotiate_protocols(NetworkSession& net, const messaging::M
 		dispatcher_.dispatch_link_event(static_cast<messaging::Service>(service), peer_, LinkState::LINK_UP);
 	}
 
-	state_ = State::FORWARDING;
 	return true;
 }
 
@@ -185,16 +353,59 @@ void MessageHandler::dispatch_message(const messaging::MessageRoot* message) {
 	}
 }
 
-bool MessageHandler::handle_message(NetworkSession& net, const std::vector<std::uint8_t>& buffer) {
-	flatbuffers::Verifier verifier(buffer.data(), buffer.size());
+/*
+ * Messages from trusted peers only have the fields read while routing them
+ * bounds checked. The rest of the message is assumed to be well formed, as the
+ * peer will have been built from the same schemas.
+ */
+bool MessageHandler::verify(const std::uint8_t* data, std::size_t size, bool trusted) {
+	if(!trusted) {
+		flatbuffers::Verifier verifier(data, size);
+		return messaging::VerifyMessageRootBuffer(verifier);
+	}
+
+	std::size_t root;
+
+	return follow_offset(data, size, 0, root) && verify_table(data, size, root)
+		&& verify_routing(data, size, root);
+}
+
+// each message in a batch is handled as if it had arrived on its own
+bool MessageHandler::dispatch_batch(const messaging::Batch* batch) {
+	if(!batch->messages()) {
+		return true;
+	}
+
+	for(auto envelope : *batch->messages()) {
+		auto data = envelope->message();
+
+		if(!data || !verify(data->data(), data->size(), trusted_)) {
+			LOG_DEBUG_FILTER(logger_, filter_)
+				<< "[spark] Batched message failed validation, dropping peer" << LOG_ASYNC;
+			return false;
+		}
+
+		auto message = messaging::GetMessageRoot(data->data());
+
+		// batches can't be nested
+		if(message->data_type() == messaging::Data::Batch) {
+			return false;
+		}
+
+		dispatch_message(message);
+	}
+
+	return true;
+}
 
-	if(!messaging::VerifyMessageRootBuffer(verifier)) {
+bool MessageHandler::handle_message(NetworkSession& net, const std::uint8_t* data, std::size_t size) {
+	if(!verify(data, size, trusted_)) {
 		LOG_DEBUG_FILTER(logger_, filter_)
 			<< "[spark] Message failed validation, dropping peer" << LOG_ASYNC;
 		return false;
 	}
 	
-	auto message = messaging::GetMessageRoot(buffer.data());
+	auto message = messaging::GetMessageRoot(data);
 
 	switch(state_) {
 		case State::HANDSHAKING:
@@ -202,6 +413,10 @@ bool MessageHandler::handle_message(NetworkSession& net, const std::vector<std::
 		case State::NEGOTIATING:
 			return negotiate_protocols(net, message);
 		case State::FORWARDING:
+			if(message->data_type() == messaging::Data::Batch) {
+				return dispatch_batch(static_cast<const messaging::Batch*>(message->data()));
+			}
+
 			dispatch_message(message);
 			return true;
 	}
@@ -218,7 +433,7 @@ void MessageHandler::start(NetworkSession& net) {
 }
 
 MessageHandler::~MessageHandler() {
-	if(state_ != State::FORWARDING) {
+	if(state_ != State::FORWARDING || !services_.remove_stripe(peer_)) {
 		return;
 	}
 
@@ -11,6 +11,7 @@
 #include <spark/NetworkSession.h>
 #include <spark/Listener.h>
 #include <boost/uuid/uuid_generators.hpp>
+#include <algorithm>
 #include <functional>
 #include <type_traits>
 
@@ -23,10 +24,17 @@ Service::Service(std::string description, boost::asio::io_service& service, cons
                  : service_(service), logger_(logger), filter_(filter), signals_(service, SIGINT, SIGTERM),
                    listener_(service, interface, port, sessions_, dispatcher_, services_, link_, logger, filter),
                    hb_service_(service_, this, logger, filter), 
-                   track_service_(service_, logger, filter),
+                   track_service_(service_, logger, filter), link_stripes_(1), host_(bai::host_name()),
+                   shared_memory_(false), trust_(Trust::NONE),
+                   batch_window_(std::chrono::microseconds(500)), batch_limit_(64), retry_budget_(0.1, 10),
                    link_ { boost::uuids::random_generator()(), std::move(description) } {
 	signals_.async_wait(std::bind(&Service::shutdown, this)); // todo, remove all async_waits
 
+	// heartbeats and realm status are small and shouldn't be held up by anything else
+	priorities_.fill(messaging::Priority::Normal);
+	default_priority(messaging::Service::Core, messaging::Priority::Control);
+	default_priority(messaging::Service::RealmStatus, messaging::Priority::Control);
+
 	dispatcher_.register_handler(&hb_service_, messaging::Service::Core, EventDispatcher::Mode::BOTH);
 	dispatcher_.register_handler(&track_service_, messaging::Service::Tracking, EventDispatcher::Mode::CLIENT);
 }
@@ -37,13 +45,21 @@ void Service::shutdown() {
 	hb_service_.shutdown();
 	listener_.shutdown();
 	sessions_.stop_all();
+
+	std::lock_guard<std::mutex> guard(batch_lock_);
+
+	for(auto& batch : batches_) {
+		batch.second.timer->cancel();
+	}
 }
 
-void Service::start_session(boost::asio::ip::tcp::socket socket) {
+void Service::start_session(boost::asio::generic::stream_protocol::socket socket,
+                            std::unique_ptr<SharedChannel> channel) {
 	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
 
-	MessageHandler m_handler(dispatcher_, services_, link_, true, logger_, filter_);
-	auto session = std::make_shared<NetworkSession>(sessions_, std::move(socket), m_handler, logger_, filter_);
+	MessageHandler m_handler(dispatcher_, services_, link_, true, trust_, logger_, filter_);
+	auto session = std::make_shared<NetworkSession>(sessions_, std::move(socket), m_handler, logger_, filter_,
+	                                                std::move(channel));
 	sessions_.start(session);
 }
 
@@ -67,9 +83,196 @@ void Service::do_connect(const std::string& host, std::uint16_t port) {
 	);
 }
 
+void Service::do_connect_local(const std::string& path, std::function<void()> fallback) {
+	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	auto socket = std::make_shared<boost::asio::local::stream_protocol::socket>(service_);
+
+	socket->async_connect(boost::asio::local::stream_protocol::endpoint(path),
+		[this, path, socket, fallback](boost::system::error_code ec) {
+			LOG_DEBUG_FILTER(logger_, filter_)
+				<< "[spark] " << (ec? "Unable to establish" : "Established")
+				<< " local connection to " << path << LOG_ASYNC;
+
+			if(ec) {
+				if(fallback) {
+					fallback();
+				}
+
+				return;
+			}
+
+			// falls back to the socket if the channel can't be created
+			std::unique_ptr<SharedChannel> channel;
+
+			if(shared_memory_) {
+				channel = SharedChannel::create(service_);
+			}
+
+			if(!SharedChannel::send_handshake(socket->native_handle(), channel.get())) {
+				LOG_WARN_FILTER(logger_, filter_)
+					<< "[spark] Unable to send handshake to " << path << LOG_ASYNC;
+				return;
+			}
+
+			start_session(std::move(*socket), std::move(channel));
+		}
+	);
+#else
+	if(fallback) {
+		fallback();
+	}
+#endif
+}
+
 void Service::connect(const std::string& host, std::uint16_t port) {
 	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
-	do_connect(host, port);
+
+	for(std::size_t i = 0; i < link_stripes_; ++i) {
+		do_connect(host, port);
+	}
+}
+
+void Service::connect_local(const std::string& path) {
+	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
+
+	for(std::size_t i = 0; i < link_stripes_; ++i) {
+		do_connect_local(path, nullptr);
+	}
+}
+
+/*
+ * Connects to a discovered service, preferring its local socket if it's
+ * running on this host. Falls back to TCP if the local connection fails.
+ */
+void Service::connect(const messaging::multicast::LocateAnswer* answer) {
+	const std::string ip = answer->ip()->str();
+	const auto port = answer->port();
+
+	if(!answer->local_path() || !answer->host() || answer->host()->str() != host_) {
+		connect(ip, port);
+		return;
+	}
+
+	for(std::size_t i = 0; i < link_stripes_; ++i) {
+		do_connect_local(answer->local_path()->str(), [this, ip, port]() {
+			do_connect(ip, port);
+		});
+	}
+}
+
+void Service::listen_local(const std::string& path) {
+	listener_.listen_local(path);
+}
+
+/*
+ * Carries links to local sockets over shared memory, where supported. Only
+ * needs to be enabled by the connecting side.
+ */
+void Service::shared_memory(bool enabled) {
+	shared_memory_ = enabled;
+}
+
+/*
+ * Inbound messages on links that both sides trust are only bounds checked
+ * rather than fully verified. Only affects links established afterwards.
+ */
+void Service::trust(Trust trust) {
+	trust_ = trust;
+	listener_.trust(trust);
+}
+
+/*
+ * Sets the number of connections opened by connect() to each peer and how
+ * messages are spread across them. The count only applies to later connects.
+ */
+void Service::link_stripes(std::size_t count, ServicesMap::Balancing balancing) {
+	link_stripes_ = std::max<std::size_t>(count, 1);
+	services_.balancing(balancing);
+}
+
+/*
+ * Sets the priority of messages for a service that don't specify their own.
+ * Replies to tracked messages are always given the reply priority instead.
+ */
+void Service::default_priority(messaging::Service service, messaging::Priority priority) {
+	priorities_[static_cast<std::size_t>(service)] = priority;
+}
+
+LaneDepths Service::lane_depths() {
+	return sessions_.lane_depths();
+}
+
+/*
+ * Bounds the outbound queue of every link. Once a queue fills, sends to the
+ * link return BACKPRESSURE until it drains below the low water marks.
+ */
+void Service::water_marks(const WaterMarks& marks) {
+	sessions_.water_marks(marks);
+}
+
+/*
+ * Caps how many queued messages, and bytes, each link gathers into a single
+ * write. Larger writes mean fewer syscalls at the cost of latency for
+ * whatever's queued behind them.
+ */
+void Service::flush_limits(const FlushLimits& limits) {
+	sessions_.flush_limits(limits);
+}
+
+bool Service::congested(const Link& link) const {
+	auto net = session(link);
+	return net && net->congested();
+}
+
+/*
+ * Picks the server for a keyed request, such as one for a given account. A peer
+ * that's congested is passed over in favour of the next choice, unless they
+ * all are, in which case the key stays where its data is most likely cached.
+ */
+boost::optional<Link> Service::route(messaging::Service service, std::uint64_t key) const {
+	boost::optional<Link> fallback;
+
+	for(auto& link : services_.rank_services(service, ServicesMap::Mode::SERVER, key)) {
+		auto net = session(link);
+
+		if(!net) {
+			continue;
+		}
+
+		if(!net->congested()) {
+			return link;
+		}
+
+		if(!fallback) {
+			fallback = link;
+		}
+	}
+
+	return fallback;
+}
+
+messaging::Priority Service::priority(const flatbuffers::FlatBufferBuilder& fbb) const {
+	auto root = messaging::GetMessageRoot(fbb.GetBufferPointer());
+
+	if(root->priority() != messaging::Priority::Default) {
+		return root->priority();
+	}
+
+	// the other side is waiting on these
+	if(root->tracking_id() && root->tracking_ttl()) {
+		return messaging::Priority::Reply;
+	}
+
+	const auto service = static_cast<std::size_t>(root->service());
+	return service < priorities_.size()? priorities_[service] : messaging::Priority::Normal;
+}
+
+// falls back to the link's own session if the peer hasn't finished negotiating
+std::shared_ptr<NetworkSession> Service::session(const Link& link) const {
+	auto net = services_.select_stripe(link);
+	return net? net : link.net.lock();
 }
 
 void Service::default_handler(const Link& link, const messaging::MessageRoot* message) {
@@ -78,42 +281,398 @@ void Service::default_handler(const Link& link, const messaging::MessageRoot* me
 }
 
 auto Service::send(const Link& link, BufferHandler fbb) const -> Result {
-	auto net = link.net.lock();
+	auto net = session(link);
 
 	if(!net) {
 		return Result::LINK_GONE;
 	}
 
-	net->write(fbb);
-	return Result::OK;
+	return to_result(net->write(fbb, priority(*fbb)));
+}
+
+auto Service::to_result(WriteResult result) -> Result {
+	switch(result) {
+		case WriteResult::QUEUED:
+			return Result::OK;
+		case WriteResult::QUEUE_FULL:
+			return Result::BACKPRESSURE;
+		case WriteResult::TOO_LARGE:
+			return Result::TOO_LARGE;
+		case WriteResult::CLOSED: // the link is about to be removed
+		default:
+			return Result::LINK_GONE;
+	}
+}
+
+// tracked requests that were dropped or couldn't be sent won't be answered, so fail them now
+void Service::fail_dropped(const std::vector<BufferHandler>& dropped) {
+	for(const auto& fbb : dropped) {
+		auto root = messaging::GetMessageRoot(fbb->GetBufferPointer());
+		auto tracking_id = root->tracking_id();
+
+		if(!tracking_id || root->tracking_ttl() || tracking_id->size() != boost::uuids::uuid::static_size()) {
+			continue;
+		}
+
+		boost::uuids::uuid id;
+		std::copy(tracking_id->begin(), tracking_id->end(), id.begin());
+		track_service_.fail_tracked(id);
+	}
+}
+
+/*
+ * The overflow policy decides whether a request sent to a full queue is
+ * refused or replaces the oldest queued messages, which are then failed.
+ */
+auto Service::send_tracked(const Link& link, boost::uuids::uuid id, BufferHandler fbb,
+                           TrackingHandler callback, Overflow overflow,
+                           std::chrono::milliseconds timeout) -> Result {
+	auto net = session(link);
+
+	if(!net) {
+		return Result::LINK_GONE;
+	}
+
+	// registered up front, as the response could arrive before write returns
+	track_service_.register_tracked(link, id, callback, timeout);
+	std::vector<BufferHandler> dropped;
+
+	const auto result = net->write(fbb, priority(*fbb), overflow, &dropped);
+
+	// messages can be evicted even if there still wasn't enough room for this one
+	fail_dropped(dropped);
+
+	if(result != WriteResult::QUEUED) {
+		track_service_.remove_tracked(id);
+	}
+
+	return to_result(result);
+}
+
+/*
+ * Messages sent with send_batched are held for up to the window, or until the
+ * limit is reached, and then sent to the peer together as a single message.
+ */
+void Service::batching(std::chrono::microseconds window, std::size_t max_messages) {
+	std::lock_guard<std::mutex> guard(batch_lock_);
+	batch_window_ = window;
+	batch_limit_ = std::max<std::size_t>(max_messages, 1);
+}
+
+bool Service::queue_batched(const Link& link, BufferHandler fbb) {
+	if(!session(link)) {
+		return false;
+	}
+
+	// large messages gain nothing from batching, but mustn't overtake those waiting
+	const bool large = fbb->GetSize() >= MAX_BATCH_BYTES;
+	std::vector<BufferHandler> ready;
+
+	{
+		std::lock_guard<std::mutex> guard(batch_lock_);
+		auto& batch = batches_[link.uuid];
+
+		if(!large) {
+			if(batch.messages.empty()) {
+				if(!batch.timer) {
+					batch.timer = std::make_unique<SteadyTimer>(service_);
+				}
+
+				batch.link = link;
+				batch.bytes = 0;
+				batch.timer->expires_from_now(batch_window_);
+				batch.timer->async_wait(std::bind(&Service::batch_expired, this, link.uuid, std::placeholders::_1));
+			}
+
+			batch.bytes += fbb->GetSize();
+			batch.messages.emplace_back(fbb);
+		}
+
+		if(large || batch.messages.size() >= batch_limit_ || batch.bytes >= MAX_BATCH_BYTES) {
+			ready.swap(batch.messages);
+		}
+	}
+
+	if(!ready.empty()) {
+		flush_batch(link, std::move(ready));
+	}
+
+	if(large) {
+		flush_batch(link, { fbb });
+	}
+
+	return true;
+}
+
+void Service::batch_expired(const boost::uuids::uuid& link, const boost::system::error_code& ec) {
+	if(ec) { // cancelled or rearmed
+		return;
+	}
+
+	std::unique_lock<std::mutex> guard(batch_lock_);
+	auto it = batches_.find(link);
+
+	if(it == batches_.end()) {
+		return;
+	}
+
+	// nothing's waiting on the timer now, so the batch can go until the next message
+	auto peer = std::move(it->second.link);
+	auto ready = std::move(it->second.messages);
+	batches_.erase(it);
+	guard.unlock();
+
+	if(!ready.empty()) {
+		flush_batch(peer, std::move(ready));
+	}
 }
 
-auto Service::send_tracked(const Link& link, boost::uuids::uuid id,
-                           BufferHandler fbb, TrackingHandler callback) -> Result {
-	auto net = link.net.lock();
+void Service::flush_batch(const Link& link, std::vector<BufferHandler> messages) {
+	auto net = session(link);
 
 	if(!net) {
+		fail_dropped(messages);
+		return;
+	}
+
+	// sent as normal if there's nothing to batch or the peer doesn't understand batches
+	if(messages.size() == 1 || !net->batching()) {
+		for(auto& fbb : messages) {
+			if(net->write(fbb, priority(*fbb)) != WriteResult::QUEUED) {
+				fail_dropped({ fbb });
+			}
+		}
+
+		return;
+	}
+
+	auto fbb = BuilderPool::acquire();
+	std::vector<flatbuffers::Offset<messaging::Envelope>> envelopes;
+	auto lane = messaging::Priority::Bulk;
+
+	for(const auto& message : messages) {
+		auto data = fbb->CreateVector(message->GetBufferPointer(), message->GetSize());
+		envelopes.emplace_back(messaging::CreateEnvelope(*fbb, data));
+		lane = std::max(lane, priority(*message));
+	}
+
+	auto batch = messaging::CreateBatch(*fbb, fbb->CreateVector(envelopes));
+	messaging::MessageRootBuilder mrb(*fbb);
+	mrb.add_service(messaging::Service::Core);
+	mrb.add_data_type(messaging::Data::Batch);
+	mrb.add_data(batch.Union());
+	mrb.add_priority(lane);
+	fbb->Finish(mrb.Finish());
+
+	if(net->write(fbb, lane) != WriteResult::QUEUED) {
+		fail_dropped(messages);
+	}
+}
+
+// for replies and other messages that can wait briefly to share a message with others
+auto Service::send_batched(const Link& link, BufferHandler fbb) -> Result {
+	return queue_batched(link, fbb)? Result::OK : Result::LINK_GONE;
+}
+
+auto Service::send_tracked_batch(const Link& link, boost::uuids::uuid id, BufferHandler fbb,
+                                 TrackingHandler callback, std::chrono::milliseconds timeout) -> Result {
+	// registered up front, as the response could arrive before the batch is written
+	track_service_.register_tracked(link, id, callback, timeout);
+	if(!queue_batched(link, fbb)) {
+		track_service_.remove_tracked(id);
 		return Result::LINK_GONE;
 	}
 
-	track_service_.register_tracked(link, id, callback, std::chrono::seconds(5));
-	net->write(fbb);
 	return Result::OK;
 }
 
+struct Service::HedgedRequest {
+	messaging::Service service;
+	RequestBuilder builder;
+	TrackingHandler callback;
+	RequestPolicy policy;
+	std::vector<Link> links;
+	std::size_t next = 0; // link for the next attempt
+	std::size_t sent = 0;
+	bool complete = false;
+	std::unordered_map<boost::uuids::uuid, std::chrono::steady_clock::time_point,
+	                   boost::hash<boost::uuids::uuid>> outstanding;
+	SteadyTimer timer;
+	std::mutex lock;
+
+	HedgedRequest(boost::asio::io_service& service) : timer(service) { }
+};
+
+/*
+ * Sends an idempotent request to the service's peers in their order of preference
+ * for the key, as with route. If the first attempt is slower than the policy's
+ * percentile of recent requests (when hedging) or fails (when retrying), further
+ * attempts are made to the next peers, up to the policy's limit and as the retry
+ * budget allows. The callback is
+ * called once, with the first answer or when every attempt has failed, and any
+ * attempts still outstanding are abandoned.
+ *
+ * Each attempt is sent with its own tracking ID, so the builder is called once
+ * for each attempt to create a message carrying that ID.
+ */
+auto Service::send_hedged(messaging::Service service, std::uint64_t key, RequestBuilder builder,
+                          TrackingHandler callback, const RequestPolicy& policy) -> Result {
+	auto request = std::make_shared<HedgedRequest>(service_);
+
+	for(auto& link : services_.rank_services(service, ServicesMap::Mode::SERVER, key)) {
+		if(session(link)) {
+			request->links.emplace_back(std::move(link));
+		}
+	}
+
+	if(request->links.empty()) {
+		return Result::LINK_GONE;
+	}
+
+	request->service = service;
+	request->builder = std::move(builder);
+	request->callback = std::move(callback);
+	request->policy = policy;
+	retry_budget_.deposit();
+
+	std::lock_guard<std::mutex> guard(request->lock);
+	const auto result = send_attempt(request);
+
+	if(result == Result::OK) {
+		schedule_hedge(request);
+	}
+
+	return result;
+}
+
+/*
+ * Tries each peer in turn until one accepts the attempt, otherwise returning why
+ * the last refused it. Attempts aren't batched, as the batch window would be
+ * counted in the latencies that hedging relies on.
+ * Must hold the request's lock
+ */
+auto Service::send_attempt(const std::shared_ptr<HedgedRequest>& request) -> Result {
+	thread_local boost::uuids::random_generator generate_uuid;
+
+	auto handler = [this, request](const Link& link, const boost::uuids::uuid& id,
+	                               boost::optional<const messaging::MessageRoot*> root) {
+		attempt_complete(request, link, id, root);
+	};
+
+	auto result = Result::LINK_GONE;
+
+	for(std::size_t i = 0; i < request->links.size(); ++i) {
+		const auto& link = request->links[request->next++ % request->links.size()];
+		const auto id = generate_uuid();
+		auto fbb = request->builder(id);
+		result = send_tracked(link, id, fbb, handler, Overflow::FAIL_FAST, request->policy.timeout);
+
+		if(result == Result::OK) {
+			request->outstanding.emplace(id, std::chrono::steady_clock::now());
+			++request->sent;
+			break;
+		}
+	}
+
+	return result;
+}
+
+// must hold the request's lock
+void Service::schedule_hedge(const std::shared_ptr<HedgedRequest>& request) {
+	if(!request->policy.hedge || request->sent >= request->policy.attempts) {
+		return;
+	}
+
+	std::chrono::microseconds delay = request->policy.delay;
+	auto& latencies = latencies_[static_cast<std::size_t>(request->service)];
+
+	if(auto percentile = latencies.percentile(request->policy.percentile)) {
+		delay = std::max(delay, *percentile);
+	}
+
+	request->timer.expires_from_now(delay);
+	request->timer.async_wait([this, request](const boost::system::error_code& ec) {
+		hedge_expired(request, ec);
+	});
+}
+
+void Service::hedge_expired(const std::shared_ptr<HedgedRequest>& request, const boost::system::error_code& ec) {
+	if(ec) { // answered before the hedge was needed
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(request->lock);
+
+	if(request->complete || request->sent >= request->policy.attempts || !retry_budget_.withdraw()) {
+		return;
+	}
+
+	if(send_attempt(request) == Result::OK) {
+		schedule_hedge(request);
+	}
+}
+
+void Service::attempt_complete(const std::shared_ptr<HedgedRequest>& request, const Link& link,
+                               const boost::uuids::uuid& id, boost::optional<const messaging::MessageRoot*> root) {
+	std::unique_lock<std::mutex> guard(request->lock);
+	auto attempt = request->outstanding.find(id);
+
+	if(request->complete || attempt == request->outstanding.end()) {
+		return;
+	}
+
+	const auto latency = std::chrono::steady_clock::now() - attempt->second;
+	request->outstanding.erase(attempt);
+
+	if(!root) {
+		// a failed attempt is retried straight away rather than waiting on the hedge
+		if(request->policy.retry && request->sent < request->policy.attempts
+		   && retry_budget_.withdraw() && send_attempt(request) == Result::OK) {
+			return;
+		}
+
+		// earlier attempts may yet be answered
+		if(!request->outstanding.empty()) {
+			return;
+		}
+	} else {
+		// answers to the other attempts will be discarded as untracked
+		for(auto& other : request->outstanding) {
+			track_service_.remove_tracked(other.first);
+		}
+
+		request->outstanding.clear();
+		latencies_[static_cast<std::size_t>(request->service)].record(
+			std::chrono::duration_cast<std::chrono::microseconds>(latency));
+	}
+
+	request->complete = true;
+	request->timer.cancel();
+	guard.unlock();
+
+	request->callback(link, id, root);
+}
+
+// extra attempts earn ratio of a token per request, with up to reserve tokens banked
+void Service::retry_budget(double ratio, double reserve) {
+	retry_budget_.reset(ratio, reserve);
+}
+
 void Service::broadcast(messaging::Service service, ServicesMap::Mode mode, BufferHandler fbb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 	const auto& links = services_.peer_services(service, mode);
+	const auto lane = priority(*fbb);
 
 	for(const auto& link : links) {
 		/* The weak_ptr should never fail to lock as the link will be removed from the
 		   services map before the network session shared_ptr goes out of scope */
-		auto shared_net = link.net.lock();
+		auto shared_net = session(link);
 		
-		if(shared_net) {
-			shared_net->write(fbb);
-		} else {
+		if(!shared_net) {
 			LOG_WARN_FILTER(logger_, filter_) << "[spark] Unable to lock weak_ptr!" << LOG_ASYNC;
+		} else if(shared_net->write(fbb, lane) != WriteResult::QUEUED) {
+			LOG_DEBUG_FILTER(logger_, filter_)
+				<< "[spark] Broadcast to " << link.description << " was refused" << LOG_ASYNC;
 		}
 	}
 }
@@ -8,6 +8,7 @@
 
 #include <spark/ServiceDiscovery.h>
 #include <spark/ServiceListener.h>
+#include <spark/BuilderPool.h>
 #include <spark/temp/Multicast_generated.h>
 #include <boost/lexical_cast.hpp>
 
@@ -20,7 +21,7 @@ ServiceDiscovery::ServiceDiscovery(boost::asio::io_service& service,
                                    std::string address, std::uint16_t port,
                                    const std::string& mcast_iface, const std::string& mcast_group,
                                    std::uint16_t mcast_port, log::Logger* logger, log::Filter filter)
-                                   : address_(std::move(address)), port_(port),
+                                   : address_(std::move(address)), port_(port), host_(bai::host_name()),
                                      socket_(service), logger_(logger), filter_(filter),
                                      signals_(service, SIGINT, SIGTERM),
                                      service_(service), endpoint_(bai::address::from_string(mcast_group), mcast_port) {
@@ -113,7 +114,7 @@ std::unique_ptr<ServiceListener> ServiceDiscovery::listener(messaging::Service s
 }
 
 void ServiceDiscovery::locate_service(messaging::Service service) {
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = BuilderPool::acquire();
 	auto msg = mcast::CreateMessageRoot(*fbb, mcast::Data::Locate,
 		mcast::CreateLocate(*fbb, service).Union());
 	fbb->Finish(msg);
@@ -121,10 +122,18 @@ void ServiceDiscovery::locate_service(messaging::Service service) {
 }
 
 void ServiceDiscovery::send_announce(messaging::Service service) {
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = BuilderPool::acquire();
 	auto ip = fbb->CreateString(address_);
+	auto host = fbb->CreateString(host_);
+	flatbuffers::Offset<flatbuffers::String> local_path;
+
+	if(!local_path_.empty()) {
+		local_path = fbb->CreateString(local_path_);
+	}
+
 	auto msg = mcast::CreateMessageRoot(*fbb, mcast::Data::LocateAnswer,
-		mcast::CreateLocateAnswer(*fbb, ip, port_, service).Union());
+		mcast::CreateLocateAnswer(*fbb, ip, port_, service, mcast::ServiceData::NONE, 0,
+		                          host, local_path).Union());
 	fbb->Finish(msg);
 	send(fbb);
 }
@@ -158,6 +167,12 @@ void ServiceDiscovery::handle_locate_answer(const mcast::LocateAnswer* message)
 	}
 }
 
+// advertises a local socket path to peers on the same host, in addition to the TCP address
+void ServiceDiscovery::announce_local(std::string path) {
+	std::lock_guard<std::mutex> guard(lock_);
+	local_path_ = std::move(path);
+}
+
 void ServiceDiscovery::register_service(messaging::Service service) {
 	std::lock_guard<std::mutex> guard(lock_);
 	services_.emplace_back(service);
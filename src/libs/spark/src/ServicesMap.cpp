@@ -7,9 +7,30 @@
  */
 
 #include <spark/ServicesMap.h>
+#include <spark/NetworkSession.h>
+#include <spark/Utility.h>
+#include <algorithm>
+#include <utility>
 
 namespace ember { namespace spark {
 
+namespace {
+
+// splitmix64 finaliser, so that similar keys and peers score independently
+std::uint64_t mix(std::uint64_t value) {
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111eb;
+	return value ^ (value >> 31);
+}
+
+std::uint64_t rendezvous_weight(const boost::uuids::uuid& peer, std::uint64_t key) {
+	return mix(detail::fnv1a(peer.data, peer.size()) + mix(key));
+}
+
+} // unnamed
+
 std::vector<Link> ServicesMap::peer_services(messaging::Service service, Mode type) const {
 	std::lock_guard<std::mutex> guard(lock_);
 
@@ -23,6 +44,30 @@ std::vector<Link> ServicesMap::peer_services(messaging::Service service, Mode ty
 	return std::vector<Link>();
 }
 
+// peers providing the service, ordered by preference for the key
+std::vector<Link> ServicesMap::rank_services(messaging::Service service, Mode type,
+                                             std::uint64_t key) const {
+	auto links = peer_services(service, type);
+	std::vector<std::pair<std::uint64_t, Link>> ranked;
+	ranked.reserve(links.size());
+
+	for(auto& link : links) {
+		ranked.emplace_back(rendezvous_weight(link.uuid, key), std::move(link));
+	}
+
+	std::sort(ranked.begin(), ranked.end(), [](const auto& lhs, const auto& rhs) {
+		return lhs.first != rhs.first? lhs.first > rhs.first : lhs.second.uuid < rhs.second.uuid;
+	});
+
+	links.clear();
+
+	for(auto& entry : ranked) {
+		links.emplace_back(std::move(entry.second));
+	}
+
+	return links;
+}
+
 void ServicesMap::register_peer_service(const Link& link, messaging::Service service, Mode type) {
 	std::lock_guard<std::mutex> guard(lock_);
 
@@ -52,4 +97,85 @@ void ServicesMap::remove_peer(const Link& link) {
 	}
 }
 
+// returns true if this is the peer's first stripe
+bool ServicesMap::add_stripe(const Link& link) {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto& stripes = stripes_[link.uuid];
+	stripes.sessions.emplace_back(link.net);
+	return stripes.sessions.size() == 1;
+}
+
+// returns true if this was the peer's last stripe
+bool ServicesMap::remove_stripe(const Link& link) {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = stripes_.find(link.uuid);
+
+	if(it == stripes_.end()) {
+		return false;
+	}
+
+	auto& sessions = it->second.sessions;
+	auto net = link.net.lock();
+
+	// the session may already be gone, in which case any expired entry will do
+	auto stripe = std::find_if(sessions.begin(), sessions.end(), [&](const auto& session) {
+		return net? session.lock() == net : session.expired();
+	});
+
+	if(stripe != sessions.end()) {
+		sessions.erase(stripe);
+	}
+
+	if(sessions.empty()) {
+		stripes_.erase(it);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Picks the connection to use for the next message to a peer. Returns null if
+ * the peer has no live stripes, such as when its link is still being established.
+ */
+std::shared_ptr<NetworkSession> ServicesMap::select_stripe(const Link& link) const {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = stripes_.find(link.uuid);
+
+	if(it == stripes_.end()) {
+		return nullptr;
+	}
+
+	auto& stripes = it->second;
+	const auto count = stripes.sessions.size();
+	std::shared_ptr<NetworkSession> selected;
+
+	for(std::size_t i = 0; i < count; ++i) {
+		auto session = stripes.sessions[(stripes.next + i) % count].lock();
+
+		if(!session) {
+			continue;
+		}
+
+		if(balancing_ == Balancing::ROUND_ROBIN) {
+			stripes.next += i;
+			selected = std::move(session);
+			break;
+		}
+
+		if(!selected || session->outstanding() < selected->outstanding()) {
+			selected = std::move(session);
+		}
+	}
+
+	// rotating the start point spreads ties between equally loaded stripes
+	++stripes.next;
+	return selected;
+}
+
+void ServicesMap::balancing(Balancing balancing) {
+	std::lock_guard<std::mutex> guard(lock_);
+	balancing_ = balancing;
+}
+
 }} // spark, ember
\ No newline at end of file
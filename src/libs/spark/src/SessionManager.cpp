@@ -11,9 +11,25 @@
 
 namespace ember { namespace spark {
 
+/*
+ * Sessions are only touched once sessions_lock_ has been released, as they call
+ * back into stop while holding their own locks.
+ */
 void SessionManager::start(std::shared_ptr<NetworkSession> session) {
-	std::lock_guard<std::mutex> guard(sessions_lock_);
+	std::unique_lock<std::mutex> guard(sessions_lock_);
 	sessions_.insert(session);
+	const auto marks = water_marks_;
+	const auto limits = flush_limits_;
+	guard.unlock();
+
+	if(marks) {
+		session->water_marks(*marks);
+	}
+
+	if(limits) {
+		session->flush_limits(*limits);
+	}
+
 	session->start();
 }
 
@@ -36,5 +52,49 @@ std::size_t SessionManager::count() const {
 	return sessions_.size();
 }
 
+auto SessionManager::snapshot() -> std::set<std::shared_ptr<NetworkSession>> {
+	std::lock_guard<std::mutex> guard(sessions_lock_);
+	return sessions_;
+}
+
+// applies to current and future sessions
+void SessionManager::water_marks(const WaterMarks& marks) {
+	{
+		std::lock_guard<std::mutex> guard(sessions_lock_);
+		water_marks_ = marks;
+	}
+
+	for(auto& session : snapshot()) {
+		session->water_marks(marks);
+	}
+}
+
+// applies to current and future sessions
+void SessionManager::flush_limits(const FlushLimits& limits) {
+	{
+		std::lock_guard<std::mutex> guard(sessions_lock_);
+		flush_limits_ = limits;
+	}
+
+	for(auto& session : snapshot()) {
+		session->flush_limits(limits);
+	}
+}
+
+// totals of each session's priority queues
+LaneDepths SessionManager::lane_depths() {
+	LaneDepths totals {};
+
+	for(auto& session : snapshot()) {
+		const auto depths = session->lane_depths();
+
+		for(std::size_t i = 0; i < totals.size(); ++i) {
+			totals[i] += depths[i];
+		}
+	}
+
+	return totals;
+}
+
 
 }} // spark, ember
\ No newline at end of file
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/SharedChannel.h>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+
+#ifndef MFD_ALLOW_SEALING // older C libraries only define the syscall
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#endif
+
+namespace ember { namespace spark {
+
+namespace {
+
+enum class Handshake : std::uint8_t {
+	SOCKET, SHARED_MEMORY
+};
+
+const std::size_t HANDSHAKE_FDS = 3; // shared memory, connector's eventfd, acceptor's eventfd
+
+} // unnamed
+
+#ifdef __linux__
+
+namespace {
+
+// the creator's outbound ring comes first
+std::size_t ring_offset() {
+	return (SharedRing::region_size(SharedChannel::RING_CAPACITY) + 63) & ~std::size_t(63);
+}
+
+// stops either side truncating the memory and faulting the other when it touches it
+const int REQUIRED_SEALS = F_SEAL_SHRINK | F_SEAL_GROW;
+
+} // unnamed
+
+struct SharedChannel::Handles {
+	int memory;
+	int peer;
+	void* region;
+	std::size_t size;
+	boost::asio::posix::stream_descriptor wake;
+	std::uint64_t counter;
+
+	Handles(boost::asio::io_service& service)
+	        : memory(-1), peer(-1), region(MAP_FAILED), size(0), wake(service), counter(0) { }
+
+	// the size is checked as the memory may have been provided by the peer
+	bool map() {
+		struct stat status;
+
+		if(fstat(memory, &status) == -1 || static_cast<std::size_t>(status.st_size) < ring_offset() * 2) {
+			return false;
+		}
+
+		size = ring_offset() * 2;
+		region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0);
+		return region != MAP_FAILED;
+	}
+
+	bool sealed() const {
+		const int seals = fcntl(memory, F_GET_SEALS);
+		return seals != -1 && (seals & REQUIRED_SEALS) == REQUIRED_SEALS;
+	}
+
+	~Handles() {
+		if(region != MAP_FAILED) {
+			munmap(region, size);
+		}
+
+		if(memory != -1) {
+			::close(memory);
+		}
+
+		if(peer != -1) {
+			::close(peer);
+		}
+	}
+};
+
+SharedChannel::SharedChannel(std::unique_ptr<Handles> handles, bool creator)
+                             : inbound_(static_cast<char*>(handles->region) + (creator? ring_offset() : 0),
+                                        RING_CAPACITY),
+                               outbound_(static_cast<char*>(handles->region) + (creator? 0 : ring_offset()),
+                                         RING_CAPACITY),
+                               handles_(std::move(handles)) {
+	if(creator) {
+		inbound_.initialise();
+		outbound_.initialise();
+	}
+}
+
+std::unique_ptr<SharedChannel> SharedChannel::create(boost::asio::io_service& service) {
+	auto handles = std::make_unique<Handles>(service);
+	handles->memory = static_cast<int>(syscall(SYS_memfd_create, "spark", MFD_ALLOW_SEALING));
+
+	if(handles->memory == -1 || ftruncate(handles->memory, ring_offset() * 2) == -1
+	   || fcntl(handles->memory, F_ADD_SEALS, REQUIRED_SEALS) == -1 || !handles->map()) {
+		return nullptr;
+	}
+
+	const int wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	handles->peer = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if(wake == -1 || handles->peer == -1) {
+		if(wake != -1) {
+			::close(wake);
+		}
+
+		return nullptr;
+	}
+
+	handles->wake.assign(wake);
+	return std::unique_ptr<SharedChannel>(new SharedChannel(std::move(handles), true));
+}
+
+bool SharedChannel::send_handshake(int socket, const SharedChannel* channel) {
+	auto type = channel? Handshake::SHARED_MEMORY : Handshake::SOCKET;
+	iovec data { &type, sizeof(type) };
+	msghdr message {};
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+
+	char control[CMSG_SPACE(sizeof(int) * HANDSHAKE_FDS)] {};
+
+	if(channel) {
+		const int fds[HANDSHAKE_FDS] {
+			channel->handles_->memory,
+			channel->handles_->wake.native_handle(),
+			channel->handles_->peer
+		};
+
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+		auto header = CMSG_FIRSTHDR(&message);
+		header->cmsg_level = SOL_SOCKET;
+		header->cmsg_type = SCM_RIGHTS;
+		header->cmsg_len = CMSG_LEN(sizeof(fds));
+		std::memcpy(CMSG_DATA(header), fds, sizeof(fds));
+	}
+
+	return sendmsg(socket, &message, MSG_NOSIGNAL) == sizeof(type);
+}
+
+bool SharedChannel::receive_handshake(boost::asio::io_service& service, int socket,
+                                      std::unique_ptr<SharedChannel>& channel) {
+	Handshake type;
+	iovec data { &type, sizeof(type) };
+	char control[CMSG_SPACE(sizeof(int) * HANDSHAKE_FDS)] {};
+	msghdr message {};
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	if(recvmsg(socket, &message, MSG_CMSG_CLOEXEC) != sizeof(type)) {
+		return false;
+	}
+
+	int fds[HANDSHAKE_FDS] { -1, -1, -1 };
+	auto header = CMSG_FIRSTHDR(&message);
+
+	if(header && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS
+	   && header->cmsg_len == CMSG_LEN(sizeof(fds))) {
+		std::memcpy(fds, CMSG_DATA(header), sizeof(fds));
+	}
+
+	// take ownership of anything received before checking it
+	auto handles = std::make_unique<Handles>(service);
+	handles->memory = fds[0];
+	handles->peer = fds[1];
+
+	if(fds[2] != -1) {
+		handles->wake.assign(fds[2]);
+	}
+
+	if(type == Handshake::SOCKET) {
+		return fds[0] == -1;
+	}
+
+	if(type != Handshake::SHARED_MEMORY || fds[0] == -1 || fds[1] == -1 || fds[2] == -1
+	   || !handles->sealed() || !handles->map()) {
+		return false;
+	}
+
+	channel.reset(new SharedChannel(std::move(handles), false));
+	return true;
+}
+
+void SharedChannel::async_wait(std::function<void(boost::system::error_code)> handler) {
+	handles_->wake.async_read_some(boost::asio::buffer(&handles_->counter, sizeof(handles_->counter)),
+		[handler](boost::system::error_code ec, std::size_t /*size*/) {
+			handler(ec);
+		}
+	);
+}
+
+void SharedChannel::notify() {
+	const std::uint64_t increment = 1;
+
+	// can only fail if the counter is saturated, in which case the peer will wake anyway
+	if(::write(handles_->peer, &increment, sizeof(increment)) == -1) {
+		return;
+	}
+}
+
+void SharedChannel::close() {
+	boost::system::error_code ec; // we don't care about any errors
+	handles_->wake.close(ec);
+}
+
+#else
+
+struct SharedChannel::Handles { };
+
+std::unique_ptr<SharedChannel> SharedChannel::create(boost::asio::io_service& /*service*/) {
+	return nullptr;
+}
+
+// never called, as a channel can't be created
+void SharedChannel::async_wait(std::function<void(boost::system::error_code)> /*handler*/) { }
+void SharedChannel::notify() { }
+void SharedChannel::close() { }
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+bool SharedChannel::send_handshake(int socket, const SharedChannel* /*channel*/) {
+	const auto type = Handshake::SOCKET;
+	return ::send(socket, &type, sizeof(type), 0) == sizeof(type);
+}
+
+bool SharedChannel::receive_handshake(boost::asio::io_service& /*service*/, int socket,
+                                      std::unique_ptr<SharedChannel>& /*channel*/) {
+	Handshake type;
+	return ::recv(socket, &type, sizeof(type), 0) == sizeof(type) && type == Handshake::SOCKET;
+}
+
+#endif
+
+#endif
+
+SharedRing& SharedChannel::inbound() {
+	return inbound_;
+}
+
+SharedRing& SharedChannel::outbound() {
+	return outbound_;
+}
+
+SharedChannel::~SharedChannel() = default;
+
+}} // spark, ember
\ No newline at end of file
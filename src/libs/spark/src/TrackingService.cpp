@@ -9,15 +9,26 @@
 #include <spark/TrackingService.h>
 #include <boost/optional.hpp>
 #include <algorithm>
+#include <functional>
 
 namespace sc = std::chrono;
 
 namespace ember { namespace spark {
 
+constexpr sc::milliseconds TrackingService::TICK;
+
 TrackingService::TrackingService(boost::asio::io_service& service, log::Logger* logger, log::Filter filter)
-                                 : service_(service), logger_(logger), filter_(filter) { }
+                                 : tick_(0), timer_(service), service_(service),
+                                   logger_(logger), filter_(filter) {
+	set_timer();
+}
 
-void TrackingService::handle_message(const Link& link, const messaging::MessageRoot* message) try {
+// tracking IDs are random UUIDs, so any byte will do for picking a shard
+auto TrackingService::shard(const boost::uuids::uuid& id) -> Shard& {
+	return shards_[id.data[id.static_size() - 1] % SHARD_COUNT];
+}
+
+void TrackingService::handle_message(const Link& link, const messaging::MessageRoot* message) {
 	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
 
 	auto recv_id = message->tracking_id();
@@ -25,26 +36,35 @@ void TrackingService::handle_message(const Link& link, const messaging::MessageR
 	if(recv_id->size() != boost::uuids::uuid::static_size()) {
 		LOG_DEBUG_FILTER(logger_, filter_)
 			<< "[spark] Received tracked message with invalid UUID length" << LOG_ASYNC;
+		return;
 	}
 
 	boost::uuids::uuid uuid;
 	std::copy(recv_id->begin(), recv_id->end(), uuid.begin());
 
-	std::unique_lock<std::mutex> guard(lock_);
-	auto handler = std::move(handlers_.at(uuid));
-	handlers_.erase(uuid);
+	auto& bucket = shard(uuid);
+	std::unique_lock<std::mutex> guard(bucket.lock);
+	auto it = bucket.requests.find(uuid);
+
+	if(it == bucket.requests.end()) {
+		guard.unlock();
+
+		LOG_DEBUG_FILTER(logger_, filter_)
+			<< "[spark] Received invalid or expired tracked message" << LOG_ASYNC;
+		return;
+	}
+
+	auto request = std::move(it->second);
+	bucket.requests.erase(it);
 	guard.unlock();
 
-	if(link != handler->link) {
+	if(link != request.link) {
 		LOG_WARN_FILTER(logger_, filter_)
 			<< "[spark] Tracked message receipient != sender" << LOG_ASYNC;
 		return;
 	}
 
-	handler->handler(link, uuid, boost::optional<const messaging::MessageRoot*>(message));
-} catch(std::out_of_range) {
-	LOG_DEBUG_FILTER(logger_, filter_)
-		<< "[spark] Received invalid or expired tracked message" << LOG_ASYNC;
+	request.handler(link, uuid, boost::optional<const messaging::MessageRoot*>(message));
 }
 
 void TrackingService::handle_link_event(const Link& link, LinkState state) {
@@ -55,34 +75,102 @@ void TrackingService::register_tracked(const Link& link, boost::uuids::uuid id,
                                        TrackingHandler handler, sc::milliseconds timeout) {
 	LOG_TRACE_FILTER(logger_, filter_) << __func__ << LOG_ASYNC;
 
-	auto request = std::make_unique<Request>(service_, id, link, handler);
-	request->timer.expires_from_now(timeout);
-	request->timer.async_wait(std::bind(&TrackingService::timeout, this, id, link, std::placeholders::_1));
+	auto& bucket = shard(id);
+	std::lock_guard<std::mutex> guard(bucket.lock);
+
+	/* The tick must be read under the shard lock - the wheel turns before the shard
+	   is locked for expiry, so the request's slot can't be passed over by a tick
+	   that's in progress. The timeout is rounded up to whole ticks, plus one for
+	   the part of the current tick that has already passed, so that requests
+	   never time out early. */
+	const auto expiry = tick_ + (timeout + TICK - sc::milliseconds(1)) / TICK + 1;
+	bucket.requests[id] = Request { id, handler, link, expiry };
+	bucket.wheel[expiry % WHEEL_SLOTS].emplace_back(id);
+}
+
+// the request's wheel entry is left to be removed as the wheel turns
+auto TrackingService::release(const boost::uuids::uuid& id) -> boost::optional<Request> {
+	auto& bucket = shard(id);
+	std::lock_guard<std::mutex> guard(bucket.lock);
+	auto it = bucket.requests.find(id);
+
+	if(it == bucket.requests.end()) {
+		return boost::none;
+	}
+
+	auto request = std::move(it->second);
+	bucket.requests.erase(it);
+	return request;
+}
+
+// for requests that were never sent, which the caller already knows about
+void TrackingService::remove_tracked(const boost::uuids::uuid& id) {
+	release(id);
+}
+
+/*
+ * Completes a request without a response, as if it had timed out. The handler
+ * is called later, as the caller may be in the middle of sending another request.
+ */
+void TrackingService::fail_tracked(const boost::uuids::uuid& id) {
+	auto request = release(id);
+
+	if(!request) {
+		return;
+	}
 
-	std::lock_guard<std::mutex> guard(lock_);
-	handlers_[id] = std::move(request);
+	service_.post([request]() {
+		request->handler(request->link, request->id, boost::optional<const messaging::MessageRoot*>());
+	});
 }
 
-void TrackingService::timeout(boost::uuids::uuid id, Link link, const boost::system::error_code& ec) {
+void TrackingService::expire(const boost::system::error_code& ec) {
 	if(ec) { // timer was cancelled
 		return;
 	}
 
-	// inform the handler that no response was received and erase
-	std::unique_lock<std::mutex> guard(lock_);
-	auto handler = std::move(handlers_.at(id));
-	handlers_.erase(id);
-	guard.unlock();
+	const auto now = ++tick_;
+	const auto slot = now % WHEEL_SLOTS;
+	std::vector<Request> expired;
 
-	handler->handler(link, id, boost::optional<const messaging::MessageRoot*>());
-}
+	for(auto& bucket : shards_) {
+		std::lock_guard<std::mutex> guard(bucket.lock);
+		auto& ids = bucket.wheel[slot];
 
-void TrackingService::shutdown() {
-	std::lock_guard<std::mutex> guard(lock_);
+		for(std::size_t i = 0; i < ids.size();) {
+			auto it = bucket.requests.find(ids[i]);
+
+			// still waiting on a later revolution of the wheel
+			if(it != bucket.requests.end() && it->second.expiry > now) {
+				++i;
+				continue;
+			}
 
-	for(auto& handler : handlers_) {
-		handler.second->timer.cancel();
+			if(it != bucket.requests.end()) {
+				expired.emplace_back(std::move(it->second));
+				bucket.requests.erase(it);
+			}
+
+			ids[i] = ids.back();
+			ids.pop_back();
+		}
+	}
+
+	// inform the handlers that no response was received
+	for(auto& request : expired) {
+		request.handler(request.link, request.id, boost::optional<const messaging::MessageRoot*>());
 	}
+
+	set_timer();
+}
+
+void TrackingService::set_timer() {
+	timer_.expires_from_now(TICK);
+	timer_.async_wait(std::bind(&TrackingService::expire, this, std::placeholders::_1));
+}
+
+void TrackingService::shutdown() {
+	timer_.cancel();
 }
 
 }} // spark, ember
\ No newline at end of file
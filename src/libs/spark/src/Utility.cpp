@@ -7,8 +7,21 @@
  */
 
 #include <spark/Utility.h>
+#include <spark/Exception.h>
 
-namespace ember { namespace spark { namespace detail {
+namespace ember { namespace spark {
+
+namespace detail {
+
+std::uint64_t fnv1a(const std::uint8_t* data, std::size_t length) {
+	std::uint64_t hash = 0xcbf29ce484222325;
+
+	for(std::size_t i = 0; i < length; ++i) {
+		hash = (hash ^ data[i]) * 0x100000001b3;
+	}
+
+	return hash;
+}
 
 std::vector<ServicesType> services_to_underlying(const std::vector<messaging::Service>& services) {
 	std::vector<ServicesType> ret;
@@ -30,4 +43,22 @@ std::vector<messaging::Service> underlying_to_services(const std::vector<Service
 	return ret;
 }
 
-}}} // detail, spark, ember
\ No newline at end of file
+} // detail
+
+std::uint64_t routing_key(const std::string& key) {
+	return detail::fnv1a(reinterpret_cast<const std::uint8_t*>(key.data()), key.size());
+}
+
+Trust trust_string(const std::string& trust) {
+	if(trust == "none") {
+		return Trust::NONE;
+	} else if(trust == "local") {
+		return Trust::LOCAL;
+	} else if(trust == "all") {
+		return Trust::ALL;
+	} else {
+		throw exception("Unknown trust passed to trust_string");
+	}
+}
+
+}} // spark, ember
\ No newline at end of file
@@ -36,7 +36,6 @@ void AccountService::handle_link_event(const spark::Link& link, spark::LinkState
 	switch(event) {
 		case spark::LinkState::LINK_UP:
 			LOG_INFO(logger_) << "Link to account server established" << LOG_ASYNC;
-			link_ = link;
 			break;
 		case spark::LinkState::LINK_DOWN:
 			LOG_INFO(logger_) << "Link to account server closed" << LOG_ASYNC;
@@ -47,7 +46,7 @@ void AccountService::handle_link_event(const spark::Link& link, spark::LinkState
 void AccountService::service_located(const messaging::multicast::LocateAnswer* message) {
 	LOG_DEBUG(logger_) << "Located account service at " << message->ip()->str() 
 	                   << ":" << message->port() << LOG_ASYNC;
-	spark_.connect(message->ip()->str(), message->port());
+	spark_.connect(message);
 }
 
 void AccountService::handle_register_reply(const spark::Link& link, const boost::uuids::uuid& uuid,
@@ -88,7 +87,7 @@ void AccountService::handle_locate_reply(const spark::Link& link, const boost::u
 void AccountService::locate_session(std::uint32_t account_id, LocateCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	auto uuid = generate_uuid();
 	auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
 	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::Account, uuid_bytes, 0,
@@ -98,7 +97,9 @@ void AccountService::locate_session(std::uint32_t account_id, LocateCB cb) const
 	auto track_cb = std::bind(&AccountService::handle_locate_reply, this, std::placeholders::_1,
 	                          std::placeholders::_2, std::placeholders::_3, cb);
 
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+	auto link = spark_.route(em::Service::Account, account_id);
+
+	if(!link || spark_.send_tracked(*link, uuid, fbb, track_cb) != spark::Service::Result::OK) {
 		cb(em::account::Status::SERVER_LINK_ERROR, 0);
 	}
 }
@@ -107,7 +108,7 @@ void AccountService::register_session(std::uint32_t account_id, const srp6::Sess
                                       RegisterCB cb) const {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	auto uuid = generate_uuid();
 	auto uuid_bytes = fbb->CreateVector(uuid.begin(), uuid.static_size());
 	auto f_key = fbb->CreateVector(key.t.data(), key.t.size());
@@ -117,8 +118,14 @@ void AccountService::register_session(std::uint32_t account_id, const srp6::Sess
 
 	auto track_cb = std::bind(&AccountService::handle_register_reply, this, std::placeholders::_1,
 	                          std::placeholders::_2, std::placeholders::_3, cb);
-	
-	if(spark_.send_tracked(link_, uuid, fbb, track_cb) != spark::Service::Result::OK) {
+
+	/*
+	 * Account servers only hold the keys registered with them, so the key must go
+	 * to the server that the gateway will route the account's lookups to.
+	 */
+	auto link = spark_.route(em::Service::Account, account_id);
+
+	if(!link || spark_.send_tracked(*link, uuid, fbb, track_cb) != spark::Service::Result::OK) {
 		cb(em::account::Status::SERVER_LINK_ERROR);
 	}
 }
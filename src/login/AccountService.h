@@ -32,7 +32,6 @@ private:
 	log::Logger* logger_;
 	std::unique_ptr<spark::ServiceListener> listener_;
 	mutable boost::uuids::random_generator generate_uuid; // functor
-	spark::Link link_;
 	
 	void service_located(const messaging::multicast::LocateAnswer* message);
 	void handle_register_reply(const spark::Link& link, const boost::uuids::uuid& uuid,
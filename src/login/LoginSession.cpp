@@ -78,17 +78,15 @@ void LoginSession::async_completion(std::shared_ptr<Action> action) try {
 	close_session();
 }
 
-// todo use a single chain here and create a write queue instead
 void LoginSession::write_chain(const grunt::Packet& packet, bool notify) {
 	LOG_TRACE_FILTER(logger_, LF_NETWORK) << __func__ << LOG_ASYNC;
 
 	LOG_TRACE_FILTER(logger_, LF_NETWORK) << remote_address() << " <- "
 		<< grunt::to_string(packet.opcode) << LOG_ASYNC;
 
-	auto chain = std::make_shared<spark::ChainedBuffer<1024>>();
-	spark::BinaryStream stream(*chain);
+	spark::BinaryStream stream(outbound_buffer());
 	packet.write_to_stream(stream);
-	NetworkSession::write_chain(chain, notify);
+	flush(notify);
 }
 
 void LoginSession::on_write_complete() {
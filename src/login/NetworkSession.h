@@ -13,9 +13,11 @@
 #include <logger/Logging.h>
 #include <spark/buffers/ChainedBuffer.h>
 #include <spark/buffers/BufferSequence.h>
+#include <spark/buffers/MutableBufferSequence.h>
 #include <shared/memory/ASIOAllocator.h>
 #include <boost/asio.hpp>
 #include <boost/lexical_cast.hpp>
+#include <array>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -26,33 +28,44 @@ namespace ember {
 
 class NetworkSession : public std::enable_shared_from_this<NetworkSession> {
 	const std::chrono::seconds SOCKET_ACTIVITY_TIMEOUT { 60 };
+	static const std::size_t INBOUND_SIZE = 1024;
+	static const std::size_t INBOUND_BLOCKS = 4; // blocks per scatter read during bursts
+	static const std::size_t OUTBOUND_SIZE = 1024;
 
 	boost::asio::ip::tcp::socket socket_;
 	boost::asio::strand strand_;
 	boost::asio::basic_waitable_timer<std::chrono::steady_clock> timer_;
 
-	spark::ChainedBuffer<1024> inbound_buffer_;
+	spark::ChainedBuffer<INBOUND_SIZE> inbound_buffer_;
+	std::size_t inbound_blocks_; // to prepare for the next read
+	std::array<spark::ChainedBuffer<OUTBOUND_SIZE>, 2> outbound_buffers_;
+	spark::ChainedBuffer<OUTBOUND_SIZE>* outbound_front_;
+	spark::ChainedBuffer<OUTBOUND_SIZE>* outbound_back_;
 	SessionManager& sessions_;
 	ASIOAllocator allocator_; // temp - should be passed in
 	const std::string remote_address_;
 	log::Logger* logger_;
 	bool stopped_;
+	bool write_in_progress_;
+	bool notify_front_; // notify once the front buffer has been sent
+	bool notify_back_;
 
 	void read() {
 		auto self(shared_from_this());
-		auto tail = inbound_buffer_.back();
 
-		// if the buffer chain has no more space left, allocate & attach new node
-		if(!tail->free()) {
-			tail = inbound_buffer_.allocate();
-			inbound_buffer_.push_back(tail);
-		}
+		// only pipelined packets, which fill the last read, are given multiple blocks
+		inbound_buffer_.prepare(inbound_blocks_);
+		spark::MutableBufferSequence<INBOUND_SIZE> sequence(inbound_buffer_);
+		const auto capacity = boost::asio::buffer_size(sequence);
 
 		set_timer();
 
-		socket_.async_receive(boost::asio::buffer(tail->write_data(), tail->free()),
+		socket_.async_receive(sequence,
 			strand_.wrap(create_alloc_handler(allocator_,
-			[this, self](boost::system::error_code ec, std::size_t size) {
+			[this, self, capacity](boost::system::error_code ec, std::size_t size) {
+				inbound_buffer_.commit(size);
+				inbound_blocks_ = size == capacity? INBOUND_BLOCKS : 1;
+
 				if(stopped_) {
 					return;
 				}
@@ -60,8 +73,6 @@ class NetworkSession : public std::enable_shared_from_this<NetworkSession> {
 				timer_.cancel();
 
 				if(!ec) {
-					inbound_buffer_.advance_write_cursor(size);
-
 					if(handle_packet(inbound_buffer_)) {
 						read();
 					} else {
@@ -74,6 +85,57 @@ class NetworkSession : public std::enable_shared_from_this<NetworkSession> {
 		)));
 	}
 
+	void write() {
+		auto self(shared_from_this());
+
+		if(!socket_.is_open()) {
+			return;
+		}
+
+		set_timer();
+
+		spark::BufferSequence<OUTBOUND_SIZE> sequence(*outbound_front_);
+
+		socket_.async_send(sequence,
+			strand_.wrap(create_alloc_handler(allocator_,
+			[this, self](boost::system::error_code ec, std::size_t size) {
+				outbound_front_->skip(size);
+
+				if(ec) {
+					if(ec != boost::asio::error::operation_aborted) {
+						close_session();
+					}
+
+					return;
+				}
+
+				if(!outbound_front_->empty()) {
+					write(); // entire buffer wasn't sent, hit gather-write limits?
+					return;
+				}
+
+				const bool notify = notify_front_;
+				swap_buffers();
+
+				if(!outbound_front_->empty()) {
+					write();
+				} else {
+					write_in_progress_ = false;
+				}
+
+				if(notify) {
+					on_write_complete();
+				}
+			}
+		)));
+	}
+
+	void swap_buffers() {
+		std::swap(outbound_front_, outbound_back_);
+		notify_front_ = notify_back_;
+		notify_back_ = false;
+	}
+
 	void set_timer() {
 		auto self(shared_from_this());
 
@@ -113,8 +175,10 @@ class NetworkSession : public std::enable_shared_from_this<NetworkSession> {
 
 public:
 	NetworkSession(SessionManager& sessions, boost::asio::ip::tcp::socket socket, log::Logger* logger)
-	               : sessions_(sessions), socket_(std::move(socket)), timer_(socket.get_io_service()),
+	               : sessions_(sessions), socket_(std::move(socket)), inbound_blocks_(1), timer_(socket.get_io_service()),
 	                 strand_(socket.get_io_service()), logger_(logger), stopped_(false),
+	                 write_in_progress_(false), notify_front_(false), notify_back_(false),
+	                 outbound_front_(&outbound_buffers_[0]), outbound_back_(&outbound_buffers_[1]),
 	                 remote_address_(boost::lexical_cast<std::string>(socket_.remote_endpoint())) { }
 
 	virtual void start() {
@@ -133,32 +197,20 @@ public:
 		sessions_.stop(shared_from_this());
 	}
 
-	template<std::size_t BlockSize>
-	void write_chain(std::shared_ptr<spark::ChainedBuffer<BlockSize>> chain, bool notify) {
-		auto self(shared_from_this());
-
-		if(!socket_.is_open()) {
-			return;
-		}
-
-		set_timer();
-
-		spark::BufferSequence<BlockSize> sequence(*chain);
+	// data written here is sent once any write already in progress has completed
+	spark::Buffer& outbound_buffer() {
+		return *outbound_back_;
+	}
 
-		socket_.async_send(sequence,
-			strand_.wrap(create_alloc_handler(allocator_,
-			[=](boost::system::error_code ec, std::size_t size) {
-				chain->skip(size);
+	// begins sending the outbound buffer, optionally notifying once it has been sent
+	void flush(bool notify) {
+		notify_back_ |= notify;
 
-				if(ec && ec != boost::asio::error::operation_aborted) {
-					close_session();
-				} else if(!ec && chain->size()) {
-					write_chain(chain, notify); 
-				} else if(notify) {
-					on_write_complete();
-				}
-			}
-		)));
+		if(!write_in_progress_) {
+			write_in_progress_ = true;
+			swap_buffers();
+			write();
+		}
 	}
 
 	boost::asio::strand& strand() { return strand_;  }
@@ -85,7 +85,7 @@ void RealmService::handle_link_event(const spark::Link& link, spark::LinkState e
 void RealmService::service_located(const messaging::multicast::LocateAnswer* message) {
 	LOG_DEBUG(logger_) << "Located realm gateway at " << message->ip()->str()
 	                   << ":" << message->port() << LOG_ASYNC;
-	spark_.connect(message->ip()->str(), message->port());
+	spark_.connect(message);
 }
 
 void RealmService::mark_realm_offline(const spark::Link& link) {
@@ -106,7 +106,7 @@ void RealmService::mark_realm_offline(const spark::Link& link) {
 void RealmService::request_realm_status(const spark::Link& link) {
 	LOG_TRACE(logger_) << __func__ << LOG_ASYNC;
 
-	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto fbb = spark::BuilderPool::acquire();
 	auto msg = messaging::CreateMessageRoot(*fbb, messaging::Service::RealmStatus, 0, 0,
 	                                         em::Data::RequestRealmStatus, 0);
 	fbb->Finish(msg);
@@ -14,6 +14,7 @@
 #include <boost/assert.hpp>
 #include <botan/bigint.h>
 #include <botan/secmem.h>
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstddef>
@@ -41,14 +42,15 @@ class LoginProof final : public Packet {
 		stream >> opcode;
 
 		// could just use one buffer but this is safer from silly mistakes
+		// reverse directly out of the stream's buffer rather than reading and then reversing
 		Botan::byte a_buff[A_LENGTH];
-		stream.get(a_buff, A_LENGTH);
-		std::reverse(std::begin(a_buff), std::end(a_buff));
+		auto a_view = stream.view(A_LENGTH);
+		std::reverse_copy(a_view, a_view + A_LENGTH, std::begin(a_buff));
 		A = Botan::BigInt(a_buff, A_LENGTH);
 
 		Botan::byte m1_buff[M1_LENGTH];
-		stream.get(m1_buff, M1_LENGTH);
-		std::reverse(std::begin(m1_buff), std::end(m1_buff));
+		auto m1_view = stream.view(M1_LENGTH);
+		std::reverse_copy(m1_view, m1_view + M1_LENGTH, std::begin(m1_buff));
 		M1 = Botan::BigInt(m1_buff, M1_LENGTH);
 
 		stream.get(client_checksum.data(), client_checksum.size());
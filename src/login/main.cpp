@@ -23,6 +23,7 @@
 #include <conpool/drivers/AutoSelect.h>
 #include <spark/Service.h>
 #include <spark/ServiceDiscovery.h>
+#include <spark/Utility.h>
 #include <shared/Banner.h>
 #include <shared/util/LogConfig.h>
 #include <shared/util/Utility.h>
@@ -186,12 +187,24 @@ void launch(const po::variables_map& args, el::Logger* logger) try {
 	auto mcast_group = args["spark.multicast_group"].as<std::string>();
 	auto mcast_iface = args["spark.multicast_interface"].as<std::string>();
 	auto mcast_port = args["spark.multicast_port"].as<std::uint16_t>();
+	auto local_socket = args["spark.local_socket"].as<std::string>();
+	auto trust = args["spark.trust"].as<std::string>();
+	auto flush_messages = args["spark.flush_messages"].as<unsigned int>();
+	auto flush_bytes = args["spark.flush_bytes"].as<unsigned int>();
 	auto spark_filter = el::Filter(ember::FilterType::LF_SPARK);
 
 	es::Service spark("login", service, s_address, s_port, logger, spark_filter);
 	es::ServiceDiscovery discovery(service, s_address, s_port, mcast_iface, mcast_group,
 	                               mcast_port, logger, spark_filter);
 
+	spark.trust(es::trust_string(trust));
+	spark.flush_limits({ flush_messages, flush_bytes });
+
+	if(!local_socket.empty()) {
+		spark.listen_local(local_socket);
+		discovery.announce_local(local_socket);
+	}
+
 	ember::AccountService acct_svc(spark, discovery, logger);
 	ember::RealmService realm_svc(realm_list, spark, discovery, logger);
 
@@ -246,6 +259,14 @@ void launch(const po::variables_map& args, el::Logger* logger) try {
 		metrics.gauge("sessions", server.connection_count());
 	}, 5s);
 
+	poller.add_source([&spark](ember::Metrics& metrics) {
+		const auto depths = spark.lane_depths();
+		metrics.gauge("spark_queue_bulk", depths[0]);
+		metrics.gauge("spark_queue_normal", depths[1]);
+		metrics.gauge("spark_queue_reply", depths[2]);
+		metrics.gauge("spark_queue_control", depths[3]);
+	}, 5s);
+
 	service.dispatch([logger]() {
 		LOG_INFO(logger) << "Login daemon started successfully" << LOG_SYNC;
 	});
@@ -306,6 +327,10 @@ po::variables_map parse_arguments(int argc, const char* argv[]) {
 		("spark.multicast_interface", po::value<std::string>()->required())
 		("spark.multicast_group", po::value<std::string>()->required())
 		("spark.multicast_port", po::value<std::uint16_t>()->required())
+		("spark.local_socket", po::value<std::string>()->default_value(""))
+		("spark.trust", po::value<std::string>()->default_value("none"))
+		("spark.flush_messages", po::value<unsigned int>()->default_value(32))
+		("spark.flush_bytes", po::value<unsigned int>()->default_value(65536))
 		("network.interface", po::value<std::string>()->required())
 		("network.port", po::value<std::uint16_t>()->required())
 		("network.tcp_no_delay", po::value<bool>()->default_value(true))
@@ -78,6 +78,8 @@ void launch(const po::variables_map& args, el::Logger* logger) try {
 	auto mcast_group = args["spark.multicast_group"].as<std::string>();
 	auto mcast_iface = args["spark.multicast_interface"].as<std::string>();
 	auto mcast_port = args["spark.multicast_port"].as<std::uint16_t>();
+	auto flush_messages = args["spark.flush_messages"].as<unsigned int>();
+	auto flush_bytes = args["spark.flush_bytes"].as<unsigned int>();
 	auto spark_filter = el::Filter(ember::FilterType::LF_SPARK);
 
 	boost::asio::io_service service;
@@ -85,6 +87,8 @@ void launch(const po::variables_map& args, el::Logger* logger) try {
 	es::ServiceDiscovery discovery(service, s_address, s_port, mcast_iface, mcast_group,
 	                               mcast_port, logger, spark_filter);
 
+	spark.flush_limits({ flush_messages, flush_bytes });
+
 	// Start metrics service
 	auto metrics = std::make_unique<ember::Metrics>();
 
@@ -138,6 +142,8 @@ po::variables_map parse_arguments(int argc, const char* argv[]) {
 		("spark.multicast_interface", po::value<std::string>()->required())
 		("spark.multicast_group", po::value<std::string>()->required())
 		("spark.multicast_port", po::value<std::uint16_t>()->required())
+		("spark.flush_messages", po::value<unsigned int>()->default_value(32))
+		("spark.flush_bytes", po::value<unsigned int>()->default_value(65536))
 		("network.interface", po::value<std::string>()->required())
 		("network.port", po::value<std::uint16_t>()->required())
 		("network.tcp_no_delay", po::value<bool>()->required())
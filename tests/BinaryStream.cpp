@@ -7,6 +7,196 @@
  */
 
 #include <spark/BinaryStream.h>
+#include <spark/SafeBinaryStream.h>
+#include <spark/buffers/ChainedBuffer.h>
 #include <gtest/gtest.h>
+#include <string>
+#include <cstring>
+#include <cstdint>
 
-namespace spark = ember::spark;
\ No newline at end of file
+namespace spark = ember::spark;
+
+TEST(BinaryStreamTest, ReadString) {
+	spark::ChainedBuffer<8> chain; // ensure the strings span multiple buffers
+	spark::BinaryStream stream(chain);
+	const std::string first("The quick brown fox");
+	const std::string second("jumps over the lazy dog");
+
+	stream << first << second;
+	ASSERT_EQ(first.size() + second.size() + 2, stream.size()) << "Stream size is incorrect";
+
+	std::string output;
+	stream >> output;
+	ASSERT_EQ(first, output) << "String read produced incorrect result";
+
+	output.clear();
+	stream >> output;
+	ASSERT_EQ(second, output) << "String read produced incorrect result";
+	ASSERT_TRUE(stream.empty()) << "Terminator was not consumed";
+}
+
+TEST(BinaryStreamTest, ReadUnterminatedString) {
+	spark::ChainedBuffer<8> chain;
+	spark::BinaryStream stream(chain);
+	const std::string input("No terminator here");
+
+	stream.put(input.data(), input.size());
+
+	std::string output;
+	stream >> output;
+	ASSERT_EQ(input, output) << "Unterminated read produced incorrect result";
+	ASSERT_TRUE(stream.empty()) << "Stream should be empty";
+}
+
+TEST(BinaryStreamTest, ReadBoundedString) {
+	spark::ChainedBuffer<8> chain;
+	spark::BinaryStream stream(chain);
+	const std::string input("Truncated");
+
+	stream << input;
+
+	std::string output;
+	ASSERT_THROW(stream.get_string(output, 5), spark::stream_read_limit);
+	ASSERT_TRUE(output.empty()) << "Bounded read truncated the string";
+	ASSERT_EQ(input.size() + 1, stream.size()) << "Failed read should not consume data";
+
+	stream.get_string(output, input.size());
+	ASSERT_EQ(input, output) << "Bounded read produced incorrect result";
+	ASSERT_TRUE(stream.empty()) << "Terminator was not consumed";
+}
+
+TEST(BinaryStreamTest, ReadBoundedUnterminated) {
+	spark::ChainedBuffer<8> chain;
+	spark::BinaryStream stream(chain);
+	const std::string input("No terminator");
+
+	stream.put(input.data(), input.size());
+
+	std::string output;
+	ASSERT_THROW(stream.get_string(output, 64), spark::buffer_underrun);
+	ASSERT_EQ(input.size(), stream.size()) << "Failed read should not consume data";
+	stream >> output;
+	ASSERT_EQ(input, output) << "Unterminated read produced incorrect result";
+}
+
+TEST(BinaryStreamTest, ReadUnboundedString) {
+	spark::ChainedBuffer<8> chain;
+	spark::BinaryStream stream(chain);
+	const std::string input("No limit");
+
+	stream << input;
+
+	std::string output;
+	stream.get_string(output, std::string::npos);
+	ASSERT_EQ(input, output) << "Unbounded read produced incorrect result";
+	ASSERT_TRUE(stream.empty()) << "Terminator was not consumed";
+}
+
+TEST(SafeBinaryStreamTest, ReadBoundedString) {
+	spark::ChainedBuffer<8> chain;
+	spark::SafeBinaryStream stream(chain);
+	const std::string input("Hostile client string");
+
+	stream << input << input;
+
+	std::string output;
+	stream.get_string(output, input.size());
+	ASSERT_EQ(input, output) << "Bounded read produced incorrect result";
+	ASSERT_THROW(stream.get_string(output, 5), spark::stream_read_limit);
+	ASSERT_EQ(input.size() + 1, stream.size()) << "Failed read should not consume data";
+}
+
+TEST(SafeBinaryStreamTest, ReadUnboundedString) {
+	spark::ChainedBuffer<8> chain;
+	spark::SafeBinaryStream stream(chain);
+	const std::string input("No limit");
+
+	stream << input;
+
+	std::string output;
+	stream.get_string(output, std::string::npos);
+	ASSERT_EQ(input, output) << "Unbounded read produced incorrect result";
+	ASSERT_TRUE(stream.empty()) << "Terminator was not consumed";
+}
+
+TEST(SafeBinaryStreamTest, ReadBoundedUnterminated) {
+	spark::ChainedBuffer<8> chain;
+	spark::SafeBinaryStream stream(chain);
+	const std::string input("No terminator");
+
+	stream.put(input.data(), input.size());
+
+	std::string output;
+	ASSERT_THROW(stream.get_string(output, 64), spark::buffer_underrun);
+	stream >> output;
+	ASSERT_EQ(input, output) << "Unterminated read produced incorrect result";
+	ASSERT_THROW(stream >> output, spark::buffer_underrun);
+}
+
+TEST(BinaryStreamTest, ContiguousView) {
+	spark::ChainedBuffer<16> chain;
+	spark::BinaryStream stream(chain);
+	const char text[] = "0123456789ABCDEFGHIJ";
+
+	stream.put(text, 20);
+
+	auto peeked = stream.peek_contiguous(10);
+	ASSERT_EQ(chain.front()->read_data(), peeked) << "Peek did not point into the buffer";
+	ASSERT_EQ(20, stream.size()) << "Peek consumed data";
+
+	auto view = stream.view(10);
+	ASSERT_EQ(peeked, view) << "View was copied despite being contiguous";
+	ASSERT_EQ(0, std::memcmp(text, view, 10)) << "View data is incorrect";
+	ASSERT_EQ(10, stream.size()) << "View did not consume data";
+	ASSERT_EQ(nullptr, stream.peek_contiguous(10)) << "Range crosses a block boundary";
+}
+
+TEST(SafeBinaryStreamTest, LinearisedView) {
+	spark::ChainedBuffer<16> chain;
+	spark::SafeBinaryStream stream(chain);
+	std::string input;
+
+	for(int i = 0; i < 200; ++i) {
+		input.push_back(static_cast<char>(i));
+	}
+
+	stream.put(input.data(), 8);
+	stream.put(input.data(), input.size());
+	stream.skip(8);
+
+	// small view crossing a boundary
+	auto view = stream.view(20);
+	ASSERT_EQ(0, std::memcmp(input.data(), view, 20)) << "Linearised view is incorrect";
+
+	// large view crossing many boundaries
+	view = stream.view(150);
+	ASSERT_EQ(0, std::memcmp(input.data() + 20, view, 150)) << "Linearised view is incorrect";
+	ASSERT_EQ(30, stream.size()) << "View did not consume data";
+	ASSERT_THROW(stream.view(31), spark::buffer_underrun);
+}
+
+TEST(BinaryStreamTest, ConcreteBufferStream) {
+	spark::ChainedBuffer<8> chain;
+	spark::BasicBinaryStream<spark::ChainedBuffer<8>> stream(chain);
+	const std::uint32_t in_first = 0xDEADBEEF, in_second = 0xBADF00D;
+	const std::uint16_t in_third = 0xF00D;
+
+	// second value straddles the block boundary
+	stream << std::uint8_t(1) << in_first << in_second << in_third << std::string("abc");
+	ASSERT_EQ(15, chain.size()) << "Chain size is incorrect";
+
+	// data should be readable through the type-erased stream
+	spark::SafeBinaryStream erased(chain);
+	std::uint8_t out_flag;
+	std::uint32_t out_first, out_second;
+	std::uint16_t out_third;
+	std::string out_str;
+
+	erased >> out_flag >> out_first >> out_second >> out_third >> out_str;
+	ASSERT_EQ(1, out_flag) << "Deserialised value is incorrect";
+	ASSERT_EQ(in_first, out_first) << "Deserialised value is incorrect";
+	ASSERT_EQ(in_second, out_second) << "Deserialised value is incorrect";
+	ASSERT_EQ(in_third, out_third) << "Deserialised value is incorrect";
+	ASSERT_EQ("abc", out_str) << "Deserialised string is incorrect";
+	ASSERT_TRUE(chain.empty()) << "Chain should be empty";
+}
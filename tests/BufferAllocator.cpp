@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/buffers/ChainedBuffer.h>
+#include <spark/buffers/allocators/TLSBlockAllocator.h>
+#include <spark/buffers/allocators/NewAllocator.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace spark = ember::spark;
+
+TEST(BufferAllocatorTest, BlockReuse) {
+	typedef spark::TLSBlockAllocator<spark::BufferBlock<24>, 4> Allocator;
+	Allocator allocator;
+	Allocator::trim();
+
+	auto block = allocator.allocate();
+	block->write("abc", 3);
+	allocator.deallocate(block);
+	ASSERT_EQ(1, Allocator::stats().cached) << "Block was not cached";
+
+	auto hits = Allocator::stats().cache_hits;
+	auto reused = allocator.allocate();
+	ASSERT_EQ(block, reused) << "Cached block was not reused";
+	ASSERT_EQ(hits + 1, Allocator::stats().cache_hits) << "Cache hit was not recorded";
+	ASSERT_EQ(0, reused->size()) << "Reused block was not reset";
+	ASSERT_EQ(0, Allocator::stats().cached) << "Cache size is incorrect";
+	allocator.deallocate(reused);
+}
+
+TEST(BufferAllocatorTest, HighWaterMark) {
+	typedef spark::TLSBlockAllocator<spark::BufferBlock<40>, 4> Allocator;
+	Allocator allocator;
+	std::vector<spark::BufferBlock<40>*> blocks;
+
+	for(int i = 0; i < 10; ++i) {
+		blocks.emplace_back(allocator.allocate());
+	}
+
+	auto released = Allocator::stats().released;
+
+	for(auto block : blocks) {
+		allocator.deallocate(block);
+	}
+
+	ASSERT_EQ(Allocator::max_cached(), Allocator::stats().cached) << "Cache exceeded its bound";
+	ASSERT_EQ(released + 6, Allocator::stats().released) << "Excess blocks were not released";
+
+	Allocator::trim(1);
+	ASSERT_EQ(1, Allocator::stats().cached) << "Trim did not release blocks";
+}
+
+TEST(BufferAllocatorTest, ChainSteadyState) {
+	typedef spark::TLSBlockAllocator<spark::BufferBlock<16>> Allocator;
+	spark::ChainedBuffer<16> chain;
+	char data[64] = {};
+
+	// warm the cache, subsequent cycles should be served entirely from it
+	chain.write(data, sizeof(data));
+	chain.skip(sizeof(data));
+
+	auto allocations = Allocator::stats().allocations;
+	auto hits = Allocator::stats().cache_hits;
+
+	for(int i = 0; i < 10; ++i) {
+		chain.write(data, sizeof(data));
+		chain.skip(sizeof(data));
+	}
+
+	auto delta = Allocator::stats().allocations - allocations;
+	ASSERT_NE(0, delta) << "Chain did not allocate through the allocator";
+	ASSERT_EQ(delta, Allocator::stats().cache_hits - hits) << "Steady state allocations missed the cache";
+}
+
+TEST(BufferAllocatorTest, CustomAllocator) {
+	spark::ChainedBuffer<16, spark::NewAllocator<spark::BufferBlock<16>>> chain;
+	int foo = 5491, output;
+
+	chain.write(&foo, sizeof(int));
+	chain.read(&output, sizeof(int));
+	ASSERT_EQ(foo, output) << "Chain output is incorrect";
+}
\ No newline at end of file
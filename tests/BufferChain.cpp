@@ -7,10 +7,14 @@
  */
 
 #include <spark/buffers/ChainedBuffer.h>
+#include <spark/buffers/ChainedCursor.h>
+#include <spark/buffers/MutableBufferSequence.h>
 #define BUFFER_SEQUENCE_DEBUG
 #include <spark/buffers/BufferSequence.h>
 #undef BUFFER_SEQUENCE_DEBUG
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -73,9 +77,9 @@ TEST(ChainedBufferTest, ReserveFetchConsistency) {
 	// store text in the retrieved buffers
 	std::size_t offset = 0;
 
-	for(auto& buffer : buffers) {
-		std::memcpy(const_cast<char*>(buffer->read_data()), text + offset, buffer->size());
-		offset += buffer->size();
+	for(auto segment : buffers) {
+		std::memcpy(segment.data, text + offset, segment.size);
+		offset += segment.size;
 
 		if(offset > text_len || !offset) {
 			break;
@@ -290,4 +294,137 @@ TEST(ChainedBufferTest, ASIOIteratorRegressionTest) {
 	chain.skip(bytes_sent);
 	ASSERT_EQ(2, bytes_sent) << "Regression found - read length was incorrect";
 	ASSERT_EQ(0, chain.size()) << "Chain size was incorrect";
+}
+
+TEST(ChainedBufferTest, ByteIterator) {
+	spark::ChainedBuffer<8> chain; // ensure the string is split over multiple buffers
+	std::string skip("Skipping");
+	std::string input("The quick brown fox jumps over the lazy dog");
+
+	chain.write(skip.data(), skip.size());
+	chain.write(input.data(), input.size());
+	chain.skip(skip.size() + 3); // start part way into a block
+
+	std::string output(chain.begin(), chain.end());
+	ASSERT_EQ(input.substr(3), output) << "Forward iteration produced incorrect result";
+
+	std::string reversed;
+
+	for(auto it = chain.end(); it != chain.begin();) {
+		reversed.push_back(*--it);
+	}
+
+	std::reverse(reversed.begin(), reversed.end());
+	ASSERT_EQ(output, reversed) << "Reverse iteration produced incorrect result";
+}
+
+TEST(ChainedBufferTest, IteratorSeek) {
+	spark::ChainedBuffer<8> chain;
+	std::string input("The quick brown fox jumps over the lazy dog");
+	chain.write(input.data(), input.size());
+
+	for(std::size_t i = 0; i < input.size(); ++i) {
+		auto it = chain.begin() + i;
+		ASSERT_EQ(input[i], *it) << "Seek produced incorrect result at " << i;
+		ASSERT_EQ(chain[i], *it) << "Seek disagrees with subscript at " << i;
+		ASSERT_EQ(std::min(8 - (i % 8), input.size() - i), it.contiguous())
+			<< "Contiguous length is incorrect";
+	}
+
+	ASSERT_TRUE(chain.begin() + input.size() == chain.end()) << "Seek to end failed";
+
+	*(chain.begin() + 10) = 'B';
+	input[10] = 'B';
+	std::string output(chain.begin(), chain.end());
+	ASSERT_EQ(input, output) << "Write through iterator failed";
+}
+
+TEST(ChainedBufferTest, Cursor) {
+	spark::ChainedBuffer<4> chain;
+	std::string input("The quick brown fox jumps over the lazy dog");
+	chain.write(input.data(), input.size());
+	spark::ChainedCursor<4> cursor(chain);
+
+	for(std::size_t i = 0; i < input.size(); ++i) {
+		ASSERT_EQ(input[i], cursor[i]) << "Sequential cursor access failed at " << i;
+	}
+
+	const std::size_t indices[] = { 40, 2, 3, 1, 0, 20, 19, 17, 42, 5 };
+
+	for(auto i : indices) {
+		ASSERT_EQ(input[i], cursor[i]) << "Random cursor access failed at " << i;
+	}
+
+	chain.skip(5);
+	cursor.reset();
+	ASSERT_EQ(input[5], cursor[0]) << "Cursor reset failed";
+}
+
+TEST(ChainedBufferTest, ScatterRead) {
+	spark::ChainedBuffer<16> chain;
+	std::string input("The quick brown fox jumps over the lazy dog");
+	std::string prefix("Partial");
+
+	chain.write(prefix.data(), prefix.size()); // partially fill the tail
+	chain.prepare(4);
+
+	spark::MutableBufferSequence<16> sequence(chain);
+	std::size_t capacity = 0, blocks = 0;
+
+	for(auto it = sequence.begin(); it != sequence.end(); ++it, ++blocks) {
+		capacity += boost::asio::buffer_size(*it);
+	}
+
+	ASSERT_EQ(4, blocks) << "Incorrect number of writable blocks";
+	ASSERT_EQ(16 * 4 - prefix.size(), capacity) << "Incorrect scatter capacity";
+
+	// simulate a receive spanning several blocks
+	ASSERT_EQ(input.size(), boost::asio::buffer_copy(sequence, boost::asio::buffer(input)));
+	chain.commit(input.size());
+	ASSERT_EQ(prefix.size() + input.size(), chain.size()) << "Chain size is incorrect";
+
+	// unused blocks should have been released so regular writes remain in order
+	chain.write(prefix.data(), prefix.size());
+
+	std::string output(chain.begin(), chain.end());
+	ASSERT_EQ(prefix + input + prefix, output) << "Scatter read produced incorrect result";
+}
+
+TEST(ChainedBufferTest, ScatterReadEmpty) {
+	spark::ChainedBuffer<16> chain;
+	std::string input("Full block input!");
+
+	chain.write(input.data(), 16);
+	chain.prepare(2);
+	chain.commit(0);
+	ASSERT_EQ(16, chain.size()) << "Chain size is incorrect";
+
+	chain.write(input.data() + 16, 1);
+	std::string output(chain.begin(), chain.end());
+	ASSERT_EQ(input, output) << "Chain contents are incorrect";
+}
+
+TEST(ChainedBufferTest, FetchSegments) {
+	spark::ChainedBuffer<8> chain;
+	const std::string input("The quick brown fox jumps over the lazy dog");
+	chain.write(input.data(), input.size());
+	chain.skip(3);
+
+	// segments start part way through a block and end part way through another
+	auto segments = chain.fetch_buffers(20, 7);
+	std::string output;
+	std::size_t count = 0;
+
+	for(auto segment : segments) {
+		output.append(segment.data, segment.size);
+		++count;
+	}
+
+	ASSERT_EQ(input.substr(10, 20), output) << "Segment contents are incorrect";
+	ASSERT_EQ(3, count) << "Incorrect number of segments";
+	ASSERT_EQ(input.size() - 3, chain.size()) << "Fetching modified the chain";
+	ASSERT_EQ(input.substr(3), std::string(chain.begin(), chain.end())) << "Fetching modified the chain";
+
+	auto empty = chain.fetch_buffers(0, 5);
+	ASSERT_TRUE(empty.begin() == empty.end()) << "Empty range should have no segments";
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/BuilderPool.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace spark = ember::spark;
+
+TEST(BuilderPoolTest, Reuse) {
+	const auto before = spark::BuilderPool::stats();
+	flatbuffers::FlatBufferBuilder* address = nullptr;
+
+	{
+		auto fbb = spark::BuilderPool::acquire();
+		fbb->Finish(fbb->CreateString("Hello, world!"));
+		address = fbb.get();
+	}
+
+	auto fbb = spark::BuilderPool::acquire();
+	const auto& after = spark::BuilderPool::stats();
+	ASSERT_EQ(address, fbb.get()) << "Released builder was not reused";
+	ASSERT_EQ(0, fbb->GetSize()) << "Reused builder was not cleared";
+	ASSERT_EQ(before.acquired + 2, after.acquired);
+	ASSERT_EQ(before.returned + 1, after.returned);
+	ASSERT_LE(before.reused + 1, after.reused);
+}
+
+TEST(BuilderPoolTest, SizeLimit) {
+	const auto before = spark::BuilderPool::stats();
+
+	{
+		auto fbb = spark::BuilderPool::acquire();
+		fbb->Finish(fbb->CreateString(std::string(1024 * 1024, 'x')));
+	}
+
+	ASSERT_EQ(before.discarded + 1, spark::BuilderPool::stats().discarded)
+		<< "Oversized builder was pooled";
+}
+
+TEST(BuilderPoolTest, CountLimit) {
+	std::vector<std::shared_ptr<flatbuffers::FlatBufferBuilder>> builders;
+
+	for(int i = 0; i < 64; ++i) {
+		builders.emplace_back(spark::BuilderPool::acquire());
+	}
+
+	const auto before = spark::BuilderPool::stats();
+	builders.clear();
+	const auto& after = spark::BuilderPool::stats();
+
+	ASSERT_EQ(64, (after.returned - before.returned) + (after.discarded - before.discarded));
+	ASSERT_LT(0, after.discarded - before.discarded) << "Pool exceeded its capacity";
+}
\ No newline at end of file
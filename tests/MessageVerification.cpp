@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/MessageHandler.h>
+#include <spark/temp/MessageRoot_generated.h>
+#include <gtest/gtest.h>
+#include <flatbuffers/flatbuffers.h>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace spark = ember::spark;
+namespace em = ember::messaging;
+
+namespace {
+
+std::vector<std::uint8_t> ping() {
+	flatbuffers::FlatBufferBuilder fbb;
+	auto msg = em::CreateMessageRoot(fbb, em::Service::Core, 0, 0, em::Data::Ping, em::CreatePing(fbb, 1).Union());
+	fbb.Finish(msg);
+	return { fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize() };
+}
+
+std::vector<std::uint8_t> tracked_ping() {
+	flatbuffers::FlatBufferBuilder fbb;
+	const std::vector<std::uint8_t> id(16, 1);
+	auto msg = em::CreateMessageRoot(fbb, em::Service::Core, fbb.CreateVector(id), 1, em::Data::Ping,
+	                                 em::CreatePing(fbb, 1).Union());
+	fbb.Finish(msg);
+	return { fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize() };
+}
+
+std::vector<std::uint8_t> batch() {
+	flatbuffers::FlatBufferBuilder fbb;
+	std::vector<flatbuffers::Offset<em::Envelope>> envelopes;
+
+	for(auto& message : { ping(), tracked_ping() }) {
+		envelopes.emplace_back(em::CreateEnvelope(fbb, fbb.CreateVector(message)));
+	}
+
+	auto msg = em::CreateMessageRoot(fbb, em::Service::Core, 0, 0, em::Data::Batch,
+	                                 em::CreateBatch(fbb, fbb.CreateVector(envelopes)).Union());
+	fbb.Finish(msg);
+	return { fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize() };
+}
+
+// where an object within the message starts
+std::size_t position(const std::vector<std::uint8_t>& message, const void* object) {
+	return static_cast<const std::uint8_t*>(object) - message.data();
+}
+
+void overwrite(std::vector<std::uint8_t>& message, std::size_t position, flatbuffers::uoffset_t value) {
+	std::memcpy(message.data() + position, &value, sizeof(value));
+}
+
+} // unnamed
+
+TEST(MessageVerificationTest, WellFormed) {
+	auto message = ping();
+	ASSERT_TRUE(spark::MessageHandler::verify(message.data(), message.size(), false));
+	ASSERT_TRUE(spark::MessageHandler::verify(message.data(), message.size(), true));
+}
+
+TEST(MessageVerificationTest, Truncated) {
+	auto message = ping();
+
+	for(std::size_t size = 0; size < sizeof(flatbuffers::uoffset_t) * 2; ++size) {
+		ASSERT_FALSE(spark::MessageHandler::verify(message.data(), size, false));
+		ASSERT_FALSE(spark::MessageHandler::verify(message.data(), size, true));
+	}
+}
+
+// trusted links must still reject a root that points outside of the message
+TEST(MessageVerificationTest, BadRoot) {
+	auto message = ping();
+	const flatbuffers::uoffset_t root = static_cast<flatbuffers::uoffset_t>(message.size());
+	std::memcpy(message.data(), &root, sizeof(root));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), false));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), true));
+}
+
+TEST(MessageVerificationTest, BadVTable) {
+	auto message = ping();
+	flatbuffers::uoffset_t root;
+	std::memcpy(&root, message.data(), sizeof(root));
+	const flatbuffers::soffset_t vtable = -static_cast<flatbuffers::soffset_t>(message.size());
+	std::memcpy(message.data() + root, &vtable, sizeof(vtable));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), false));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), true));
+}
+
+TEST(MessageVerificationTest, WellFormedBatch) {
+	auto message = batch();
+	ASSERT_TRUE(spark::MessageHandler::verify(message.data(), message.size(), false));
+	ASSERT_TRUE(spark::MessageHandler::verify(message.data(), message.size(), true));
+}
+
+// the tracking ID is read while routing, so trusted links must bounds check it
+TEST(MessageVerificationTest, BadTrackingID) {
+	auto message = tracked_ping();
+	ASSERT_TRUE(spark::MessageHandler::verify(message.data(), message.size(), true));
+
+	const auto id = position(message, em::GetMessageRoot(message.data())->tracking_id());
+	overwrite(message, id, static_cast<flatbuffers::uoffset_t>(message.size()));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), false));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), true));
+}
+
+// batches are unpacked while routing, so trusted links must bounds check the envelopes
+TEST(MessageVerificationTest, BadBatch) {
+	const auto original = batch();
+	auto root = em::GetMessageRoot(original.data());
+	auto messages = static_cast<const em::Batch*>(root->data())->messages();
+	const auto count = position(original, messages);
+	const auto first = count + sizeof(flatbuffers::uoffset_t);
+	const auto nested = position(original, messages->Get(0)->message());
+
+	auto message = original;
+	overwrite(message, count, static_cast<flatbuffers::uoffset_t>(message.size()));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), true)) << "Bad envelope count";
+
+	message = original;
+	overwrite(message, first, static_cast<flatbuffers::uoffset_t>(message.size()));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), true)) << "Bad envelope offset";
+
+	message = original;
+	overwrite(message, nested, static_cast<flatbuffers::uoffset_t>(message.size()));
+	ASSERT_FALSE(spark::MessageHandler::verify(message.data(), message.size(), true)) << "Bad nested message";
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/ServicesMap.h>
+#include <spark/Utility.h>
+#include <gtest/gtest.h>
+#include <boost/uuid/uuid_generators.hpp>
+#include <map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace spark = ember::spark;
+namespace em = ember::messaging;
+
+namespace {
+
+const std::uint64_t KEYS = 10000;
+
+spark::Link make_link() {
+	static boost::uuids::random_generator generate_uuid;
+	return { generate_uuid(), "account", {} };
+}
+
+void register_links(spark::ServicesMap& map, const std::vector<spark::Link>& links) {
+	for(auto& link : links) {
+		map.register_peer_service(link, em::Service::Account, spark::ServicesMap::Mode::SERVER);
+	}
+}
+
+std::vector<boost::uuids::uuid> owners(const spark::ServicesMap& map) {
+	std::vector<boost::uuids::uuid> owners;
+
+	for(std::uint64_t key = 0; key < KEYS; ++key) {
+		owners.emplace_back(map.rank_services(em::Service::Account, spark::ServicesMap::Mode::SERVER, key)[0].uuid);
+	}
+
+	return owners;
+}
+
+} // unnamed
+
+TEST(ServiceRoutingTest, Ranking) {
+	std::vector<spark::Link> links { make_link(), make_link(), make_link() };
+	spark::ServicesMap map;
+	register_links(map, links);
+
+	auto ranked = map.rank_services(em::Service::Account, spark::ServicesMap::Mode::SERVER, 42);
+	ASSERT_EQ(links.size(), ranked.size());
+	ASSERT_EQ(ranked, map.rank_services(em::Service::Account, spark::ServicesMap::Mode::SERVER, 42));
+	ASSERT_TRUE(map.rank_services(em::Service::Character, spark::ServicesMap::Mode::SERVER, 42).empty());
+	ASSERT_TRUE(map.rank_services(em::Service::Account, spark::ServicesMap::Mode::CLIENT, 42).empty());
+}
+
+// keys derived from strings must route identically on every build
+TEST(ServiceRoutingTest, StableKeys) {
+	ASSERT_EQ(0xcbf29ce484222325, spark::routing_key(""));
+	ASSERT_EQ(0xaf63dc4c8601ec8c, spark::routing_key("a"));
+	ASSERT_EQ(0x85944171f73967e8, spark::routing_key("foobar"));
+}
+
+TEST(ServiceRoutingTest, Spread) {
+	std::vector<spark::Link> links { make_link(), make_link(), make_link(), make_link() };
+	spark::ServicesMap map;
+	register_links(map, links);
+	std::map<boost::uuids::uuid, std::size_t> counts;
+
+	for(auto& owner : owners(map)) {
+		++counts[owner];
+	}
+
+	ASSERT_EQ(links.size(), counts.size());
+
+	for(auto& count : counts) {
+		ASSERT_GT(count.second, KEYS / links.size() * 8 / 10);
+		ASSERT_LT(count.second, KEYS / links.size() * 12 / 10);
+	}
+}
+
+/*
+ * The login server registers session keys and the gateway looks them up, each
+ * routing on the account ID from its own view of the account servers. Both
+ * views must agree on which server holds each key, whatever order the servers
+ * were found in.
+ */
+TEST(ServiceRoutingTest, SessionKeysFollowAccount) {
+	std::vector<spark::Link> instances { make_link(), make_link() };
+	spark::ServicesMap login, gateway;
+	register_links(login, instances);
+	register_links(gateway, { instances[1], instances[0] });
+	std::map<boost::uuids::uuid, std::size_t> counts;
+
+	for(std::uint64_t account_id = 0; account_id < KEYS; ++account_id) {
+		const auto registered = login.rank_services(em::Service::Account, spark::ServicesMap::Mode::SERVER, account_id);
+		const auto located = gateway.rank_services(em::Service::Account, spark::ServicesMap::Mode::SERVER, account_id);
+		ASSERT_EQ(registered[0].uuid, located[0].uuid) << "Key looked up on a server it wasn't registered with";
+		++counts[registered[0].uuid];
+	}
+
+	ASSERT_EQ(instances.size(), counts.size()) << "Keys weren't spread over both servers";
+}
+
+// only the keys owned by a departing peer should move
+TEST(ServiceRoutingTest, Leave) {
+	std::vector<spark::Link> links { make_link(), make_link(), make_link(), make_link() };
+	spark::ServicesMap map;
+	register_links(map, links);
+	const auto before = owners(map);
+
+	map.remove_peer(links[1]);
+	const auto after = owners(map);
+
+	for(std::uint64_t key = 0; key < KEYS; ++key) {
+		if(before[key] == links[1].uuid) {
+			ASSERT_NE(links[1].uuid, after[key]);
+		} else {
+			ASSERT_EQ(before[key], after[key]);
+		}
+	}
+}
+
+// keys should only move to a joining peer, never between existing ones
+TEST(ServiceRoutingTest, Join) {
+	std::vector<spark::Link> links { make_link(), make_link(), make_link() };
+	spark::ServicesMap map;
+	register_links(map, links);
+	const auto before = owners(map);
+
+	auto joined = make_link();
+	map.register_peer_service(joined, em::Service::Account, spark::ServicesMap::Mode::SERVER);
+	const auto after = owners(map);
+	std::size_t moved = 0;
+
+	for(std::uint64_t key = 0; key < KEYS; ++key) {
+		if(before[key] != after[key]) {
+			ASSERT_EQ(joined.uuid, after[key]);
+			++moved;
+		}
+	}
+
+	ASSERT_GT(moved, KEYS / 4 * 8 / 10);
+	ASSERT_LT(moved, KEYS / 4 * 12 / 10);
+}
\ No newline at end of file
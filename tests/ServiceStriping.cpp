@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/ServicesMap.h>
+#include <spark/EventDispatcher.h>
+#include <spark/MessageHandler.h>
+#include <spark/NetworkSession.h>
+#include <spark/SessionManager.h>
+#include <logger/Logging.h>
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <flatbuffers/flatbuffers.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace spark = ember::spark;
+namespace local = boost::asio::local;
+
+namespace {
+
+/*
+ * Sessions connected to sockets within this process. The service is never run,
+ * so anything written to a stripe stays outstanding for the whole test.
+ */
+class ServiceStripingTest : public ::testing::Test {
+protected:
+	ember::log::Logger logger;
+	spark::EventDispatcher dispatcher;
+	spark::SessionManager sessions;
+	spark::ServicesMap services;
+	boost::asio::io_service service;
+	std::vector<local::stream_protocol::socket> peers;
+	const spark::Link peer { boost::uuids::random_generator()(), "account", {} };
+
+	std::shared_ptr<spark::NetworkSession> make_session() {
+		local::stream_protocol::socket socket(service);
+		peers.emplace_back(service);
+		local::connect_pair(socket, peers.back());
+
+		spark::MessageHandler handler(dispatcher, services, peer, true, spark::Trust::NONE,
+		                              &logger, ember::log::Filter(0));
+		return std::make_shared<spark::NetworkSession>(sessions, std::move(socket), handler,
+		                                               &logger, ember::log::Filter(0));
+	}
+
+	// the link as seen by the handler of the given stripe
+	spark::Link stripe(const std::shared_ptr<spark::NetworkSession>& session) const {
+		return { peer.uuid, peer.description, session };
+	}
+
+	std::vector<std::shared_ptr<spark::NetworkSession>> add_stripes(std::size_t count) {
+		std::vector<std::shared_ptr<spark::NetworkSession>> stripes;
+
+		for(std::size_t i = 0; i < count; ++i) {
+			stripes.emplace_back(make_session());
+			services.add_stripe(stripe(stripes.back()));
+		}
+
+		return stripes;
+	}
+
+	void write(spark::NetworkSession& session) {
+		auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+		fbb->Finish(fbb->CreateString("stripe"));
+		ASSERT_EQ(spark::WriteResult::QUEUED, session.write(fbb));
+	}
+};
+
+} // unnamed
+
+// the link only comes up, and its services are only registered, for the first stripe
+TEST_F(ServiceStripingTest, LinkUpOnFirstStripe) {
+	auto first = make_session();
+	auto second = make_session();
+	auto third = make_session();
+
+	ASSERT_TRUE(services.add_stripe(stripe(first)));
+	ASSERT_FALSE(services.add_stripe(stripe(second))) << "Additional stripe reported as a new link";
+	ASSERT_FALSE(services.add_stripe(stripe(third))) << "Additional stripe reported as a new link";
+}
+
+// the link only goes down once its last stripe has closed, in whatever order they close
+TEST_F(ServiceStripingTest, LinkDownOnLastStripe) {
+	auto stripes = add_stripes(3);
+
+	ASSERT_FALSE(services.remove_stripe(stripe(stripes[1]))) << "Link went down with stripes remaining";
+	ASSERT_FALSE(services.remove_stripe(stripe(stripes[0]))) << "Link went down with stripes remaining";
+	ASSERT_TRUE(services.remove_stripe(stripe(stripes[2])));
+	ASSERT_FALSE(services.remove_stripe(stripe(stripes[2]))) << "Link went down twice";
+	ASSERT_EQ(nullptr, services.select_stripe(peer));
+}
+
+// a stripe's session may be destroyed before its handler removes it
+TEST_F(ServiceStripingTest, RemoveExpiredStripe) {
+	auto stripes = add_stripes(2);
+	const auto expired = stripe(stripes[0]);
+	stripes[0].reset();
+
+	ASSERT_FALSE(services.remove_stripe(expired)) << "Link went down with stripes remaining";
+	ASSERT_EQ(stripes[1], services.select_stripe(peer));
+	ASSERT_TRUE(services.remove_stripe(stripe(stripes[1])));
+}
+
+TEST_F(ServiceStripingTest, RoundRobin) {
+	services.balancing(spark::ServicesMap::Balancing::ROUND_ROBIN);
+	auto stripes = add_stripes(3);
+	write(*stripes[0]); // load is ignored
+
+	for(std::size_t i = 0; i < stripes.size() * 3; ++i) {
+		ASSERT_EQ(stripes[i % stripes.size()], services.select_stripe(peer)) << "Stripes not taken in turn";
+	}
+}
+
+TEST_F(ServiceStripingTest, LeastOutstanding) {
+	services.balancing(spark::ServicesMap::Balancing::LEAST_OUTSTANDING);
+	auto stripes = add_stripes(3);
+	write(*stripes[0]);
+	write(*stripes[2]);
+	write(*stripes[2]);
+
+	for(std::size_t i = 0; i < stripes.size() * 3; ++i) {
+		ASSERT_EQ(stripes[1], services.select_stripe(peer)) << "Busier stripe selected";
+	}
+
+	write(*stripes[1]);
+	write(*stripes[1]);
+
+	for(std::size_t i = 0; i < stripes.size() * 3; ++i) {
+		ASSERT_EQ(stripes[0], services.select_stripe(peer)) << "Busier stripe selected";
+	}
+}
+
+// equally loaded stripes should share the traffic rather than one taking all of it
+TEST_F(ServiceStripingTest, LeastOutstandingTies) {
+	services.balancing(spark::ServicesMap::Balancing::LEAST_OUTSTANDING);
+	auto stripes = add_stripes(3);
+	std::map<std::shared_ptr<spark::NetworkSession>, std::size_t> counts;
+	const std::size_t rounds = 10;
+
+	for(std::size_t i = 0; i < stripes.size() * rounds; ++i) {
+		++counts[services.select_stripe(peer)];
+	}
+
+	ASSERT_EQ(stripes.size(), counts.size());
+
+	for(auto& count : counts) {
+		ASSERT_EQ(rounds, count.second);
+	}
+}
+
+TEST_F(ServiceStripingTest, SkipDeadStripes) {
+	auto stripes = add_stripes(3);
+	stripes[0].reset();
+	stripes[2].reset();
+
+	for(std::size_t i = 0; i < 6; ++i) {
+		ASSERT_EQ(stripes[1], services.select_stripe(peer)) << "Dead stripe selected";
+	}
+
+	stripes[1].reset();
+	ASSERT_EQ(nullptr, services.select_stripe(peer));
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/SharedRing.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace spark = ember::spark;
+
+namespace {
+
+const std::size_t CAPACITY = 1024;
+
+struct Ring {
+	alignas(64) std::uint8_t memory[spark::SharedRing::region_size(CAPACITY)];
+	spark::SharedRing ring;
+
+	Ring() : ring(memory, CAPACITY) {
+		ring.initialise();
+	}
+};
+
+} // unnamed
+
+TEST(SharedRingTest, ReadWrite) {
+	Ring ring;
+	std::vector<std::uint8_t> input(100);
+	std::iota(input.begin(), input.end(), 0);
+
+	ASSERT_TRUE(ring.ring.empty());
+	ASSERT_TRUE(ring.ring.write(input.data(), input.size()));
+	ASSERT_FALSE(ring.ring.empty());
+
+	const std::uint8_t* data;
+	std::size_t size;
+	ASSERT_TRUE(ring.ring.peek(data, size));
+	ASSERT_EQ(input.size(), size);
+	ASSERT_EQ(0, std::memcmp(input.data(), data, size));
+
+	ring.ring.pop(size);
+	ASSERT_TRUE(ring.ring.empty());
+	ASSERT_FALSE(ring.ring.peek(data, size));
+}
+
+TEST(SharedRingTest, Full) {
+	Ring ring;
+	const auto max = ring.ring.max_message_size();
+	std::vector<std::uint8_t> input(max + 1);
+
+	ASSERT_FALSE(ring.ring.write(input.data(), max + 1)) << "Oversized message accepted";
+	ASSERT_TRUE(ring.ring.write(input.data(), max));
+	ASSERT_TRUE(ring.ring.write(input.data(), max));
+	ASSERT_FALSE(ring.ring.write(input.data(), 1)) << "Write to full ring succeeded";
+
+	const std::uint8_t* data;
+	std::size_t size;
+	ASSERT_TRUE(ring.ring.peek(data, size));
+	ring.ring.pop(size);
+	ASSERT_TRUE(ring.ring.write(input.data(), 1));
+}
+
+// messages must remain contiguous when the ring wraps around
+TEST(SharedRingTest, WrapAround) {
+	Ring ring;
+	const std::uint8_t* data;
+	std::size_t size;
+
+	for(std::size_t i = 0; i < 500; ++i) {
+		std::vector<std::uint8_t> input((i * 37) % 300 + 1, static_cast<std::uint8_t>(i));
+		ASSERT_TRUE(ring.ring.write(input.data(), input.size()));
+		ASSERT_TRUE(ring.ring.peek(data, size));
+		ASSERT_EQ(input.size(), size);
+		ASSERT_TRUE(std::all_of(data, data + size, [i](auto byte) { return byte == std::uint8_t(i); }));
+		ring.ring.pop(size);
+	}
+
+	ASSERT_TRUE(ring.ring.empty());
+}
+
+TEST(SharedRingTest, Wakeups) {
+	Ring ring;
+	const std::uint8_t byte = 0;
+
+	ASSERT_TRUE(ring.ring.consumer_wait());
+	ASSERT_TRUE(ring.ring.write(&byte, sizeof(byte)));
+	ASSERT_TRUE(ring.ring.wake_consumer());
+	ASSERT_FALSE(ring.ring.wake_consumer()) << "Consumer woken twice";
+	ASSERT_FALSE(ring.ring.consumer_wait()) << "Consumer waiting on non-empty ring";
+
+	ASSERT_FALSE(ring.ring.wake_producer());
+	ring.ring.producer_wait();
+	ASSERT_TRUE(ring.ring.wake_producer());
+}
\ No newline at end of file
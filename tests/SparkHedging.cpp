@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/Service.h>
+#include <spark/EventHandler.h>
+#include <spark/Hedging.h>
+#include <logger/Logging.h>
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace spark = ember::spark;
+namespace messaging = ember::messaging;
+namespace sc = std::chrono;
+
+TEST(HedgingTest, LatencyPercentile) {
+	spark::LatencyWindow window;
+	window.record(sc::microseconds(1));
+	ASSERT_FALSE(window.percentile(0.5)) << "Percentile given without enough samples";
+
+	for(int i = 2; i <= 100; ++i) {
+		window.record(sc::microseconds(i));
+	}
+
+	ASSERT_EQ(sc::microseconds(1), *window.percentile(0.0));
+	ASSERT_EQ(sc::microseconds(50), *window.percentile(0.5));
+	ASSERT_EQ(sc::microseconds(100), *window.percentile(1.0));
+}
+
+TEST(HedgingTest, RetryBudget) {
+	spark::RetryBudget budget(0.5, 2);
+	ASSERT_TRUE(budget.withdraw());
+	ASSERT_TRUE(budget.withdraw());
+	ASSERT_FALSE(budget.withdraw()) << "Reserve overdrawn";
+
+	budget.deposit();
+	ASSERT_FALSE(budget.withdraw());
+	budget.deposit();
+	ASSERT_TRUE(budget.withdraw());
+
+	for(int i = 0; i < 10; ++i) {
+		budget.deposit();
+	}
+
+	ASSERT_TRUE(budget.withdraw());
+	ASSERT_TRUE(budget.withdraw());
+	ASSERT_FALSE(budget.withdraw()) << "Balance exceeded its cap";
+}
+
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace {
+
+/*
+ * Stands in for an account server that stalls, holding every request it's sent
+ * until told to answer. Nothing here depends on how long anything takes.
+ */
+class StalledPeer final : public spark::EventHandler {
+	typedef std::shared_ptr<flatbuffers::FlatBufferBuilder> Message;
+
+	spark::Service& spark_;
+	boost::asio::io_service& service_;
+	std::vector<std::pair<spark::Link, Message>> held_;
+	std::promise<void> received_;
+	std::atomic_bool signalled_ { false };
+
+	static Message build_response(const messaging::MessageRoot* root) {
+		auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+		auto id = fbb->CreateVector(root->tracking_id()->data(), root->tracking_id()->size());
+		auto response = messaging::account::CreateResponse(*fbb, messaging::account::Status::OK);
+		fbb->Finish(messaging::CreateMessageRoot(*fbb, messaging::Service::Account, id, 1,
+			messaging::Data::Response, response.Union()));
+		return fbb;
+	}
+
+	// untracked, so it's handed to the client's observer rather than the tracking service
+	static Message build_marker() {
+		auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+		auto response = messaging::account::CreateResponse(*fbb, messaging::account::Status::OK);
+		fbb->Finish(messaging::CreateMessageRoot(*fbb, messaging::Service::Account, 0, 0,
+			messaging::Data::Response, response.Union()));
+		return fbb;
+	}
+
+public:
+	StalledPeer(spark::Service& spark, boost::asio::io_service& service)
+	            : spark_(spark), service_(service) { }
+
+	void handle_message(const spark::Link& link, const messaging::MessageRoot* root) override {
+		held_.emplace_back(link, build_response(root));
+
+		if(!signalled_.exchange(true)) {
+			received_.set_value();
+		}
+	}
+
+	void handle_link_event(const spark::Link&, spark::LinkState) override { }
+
+	std::future<void> received() {
+		return received_.get_future();
+	}
+
+	/*
+	 * Answers every held request, optionally followed by a marker. Messages on a
+	 * link arrive in order, so once the marker has been seen, so have the answers.
+	 */
+	void release(bool marker) {
+		service_.post([this, marker]() {
+			for(auto& request : held_) {
+				spark_.send(request.first, request.second);
+
+				if(marker) {
+					spark_.send(request.first, build_marker());
+				}
+			}
+
+			held_.clear();
+		});
+	}
+};
+
+class LinkObserver final : public spark::EventHandler {
+	std::promise<void> up_;
+	std::promise<void> marked_;
+	std::atomic<std::size_t> remaining_;
+	std::atomic_bool marked_signalled_ { false };
+
+public:
+	explicit LinkObserver(std::size_t links) : remaining_(links) { }
+
+	void handle_message(const spark::Link&, const messaging::MessageRoot*) override {
+		if(!marked_signalled_.exchange(true)) {
+			marked_.set_value();
+		}
+	}
+
+	void handle_link_event(const spark::Link&, spark::LinkState state) override {
+		if(state == spark::LinkState::LINK_UP && --remaining_ == 0) {
+			up_.set_value();
+		}
+	}
+
+	std::future<void> links_up() {
+		return up_.get_future();
+	}
+
+	std::future<void> marked() {
+		return marked_.get_future();
+	}
+};
+
+std::shared_ptr<flatbuffers::FlatBufferBuilder> build_lookup(const boost::uuids::uuid& uuid) {
+	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto id = fbb->CreateVector(uuid.begin(), uuid.static_size());
+	fbb->Finish(messaging::CreateMessageRoot(*fbb, messaging::Service::Account, id, 0,
+		messaging::Data::KeyLookup, messaging::account::CreateKeyLookup(*fbb, 1).Union()));
+	return fbb;
+}
+
+// a client linked to two account servers over local sockets, both of which stall
+class HedgedRequestTest : public ::testing::Test {
+protected:
+	boost::asio::io_service service;
+	ember::log::Logger logger;
+	spark::Service first { "first", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	spark::Service second { "second", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	spark::Service client { "client", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	StalledPeer first_handler { first, service };
+	StalledPeer second_handler { second, service };
+	LinkObserver observer { 2 };
+	std::unique_ptr<boost::asio::io_service::work> work;
+	std::thread worker;
+
+	std::string socket_path() {
+		return (boost::filesystem::temp_directory_path()
+			/ boost::filesystem::unique_path("ember-spark-%%%%-%%%%.sock")).string();
+	}
+
+	void SetUp() override {
+		first.dispatcher()->register_handler(&first_handler, messaging::Service::Account,
+		                                     spark::EventDispatcher::Mode::SERVER);
+		second.dispatcher()->register_handler(&second_handler, messaging::Service::Account,
+		                                      spark::EventDispatcher::Mode::SERVER);
+		client.dispatcher()->register_handler(&observer, messaging::Service::Account,
+		                                      spark::EventDispatcher::Mode::CLIENT);
+
+		const auto first_path = socket_path(), second_path = socket_path();
+		first.listen_local(first_path);
+		second.listen_local(second_path);
+		client.connect_local(first_path);
+		client.connect_local(second_path);
+
+		auto links_up = observer.links_up();
+		work = std::make_unique<boost::asio::io_service::work>(service);
+		worker = std::thread([&]() { service.run(); });
+		ASSERT_EQ(std::future_status::ready, links_up.wait_for(sc::seconds(5))) << "Links were not established";
+	}
+
+	void TearDown() override {
+		client.shutdown();
+		first.shutdown();
+		second.shutdown();
+		work.reset();
+		service.stop();
+		worker.join();
+		client.dispatcher()->remove_handler(&observer);
+		first.dispatcher()->remove_handler(&first_handler);
+		second.dispatcher()->remove_handler(&second_handler);
+	}
+};
+
+} // unnamed
+
+/*
+ * Neither peer answers and the attempts can't time out during the test, so a
+ * request reaching both peers can only be the hedge. Once one is answered, the
+ * other's late answer must be discarded rather than reaching the callback.
+ */
+TEST_F(HedgedRequestTest, HedgeStalledPeer) {
+	client.retry_budget(1.0, 1);
+	const spark::RequestPolicy policy { 2, true, false, 0.95, sc::milliseconds(1), sc::minutes(10) };
+	std::atomic<std::size_t> answers { 0 };
+	std::promise<std::string> answered;
+	auto answered_by = answered.get_future();
+	auto first_received = first_handler.received();
+	auto second_received = second_handler.received();
+
+	auto result = client.send_hedged(messaging::Service::Account, 1, build_lookup,
+		[&](const spark::Link& link, const boost::uuids::uuid&, boost::optional<const messaging::MessageRoot*> root) {
+			EXPECT_TRUE(root && (*root)->data_type() == messaging::Data::Response);
+
+			if(answers++ == 0) {
+				answered.set_value(link.description);
+			}
+		}, policy);
+
+	ASSERT_EQ(spark::Service::Result::OK, result);
+	ASSERT_EQ(std::future_status::ready, first_received.wait_for(sc::seconds(10))) << "Request was not sent";
+	ASSERT_EQ(std::future_status::ready, second_received.wait_for(sc::seconds(10))) << "Request was not hedged";
+
+	first_handler.release(false);
+	ASSERT_EQ(std::future_status::ready, answered_by.wait_for(sc::seconds(10))) << "Request was never answered";
+	ASSERT_EQ("first", answered_by.get());
+
+	auto marked = observer.marked();
+	second_handler.release(true);
+	ASSERT_EQ(std::future_status::ready, marked.wait_for(sc::seconds(10))) << "Late answer was not sent";
+	ASSERT_EQ(1u, answers.load()) << "Abandoned attempt was not cancelled";
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/Service.h>
+#include <spark/EventHandler.h>
+#include <spark/Hedging.h>
+#include <logger/Logging.h>
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * These tests depend on wall clock timing, so they're built as timing_tests
+ * rather than as part of unit_tests, which is run by ctest. They should only
+ * join unit_tests once they've been shown to be stable on loaded machines.
+ */
+
+namespace spark = ember::spark;
+namespace messaging = ember::messaging;
+namespace sc = std::chrono;
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace {
+
+const sc::milliseconds SLOW_REPLY { 300 };
+const std::size_t WAVES = 10;
+const std::size_t WAVE_SIZE = 20;
+
+// stands in for an account server, answering every request after a delay
+class StandIn final : public spark::EventHandler {
+	spark::Service& spark_;
+	boost::asio::io_service& service_;
+	const sc::milliseconds delay_;
+
+public:
+	StandIn(spark::Service& spark, boost::asio::io_service& service, sc::milliseconds delay)
+	        : spark_(spark), service_(service), delay_(delay) { }
+
+	void handle_message(const spark::Link& link, const messaging::MessageRoot* root) override {
+		auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+		auto id = fbb->CreateVector(root->tracking_id()->data(), root->tracking_id()->size());
+		auto response = messaging::account::CreateResponse(*fbb, messaging::account::Status::OK);
+		fbb->Finish(messaging::CreateMessageRoot(*fbb, messaging::Service::Account, id, 1,
+			messaging::Data::Response, response.Union()));
+
+		auto timer = std::make_shared<boost::asio::steady_timer>(service_, delay_);
+		timer->async_wait([this, timer, link, fbb](const boost::system::error_code&) {
+			spark_.send(link, fbb);
+		});
+	}
+
+	void handle_link_event(const spark::Link&, spark::LinkState) override { }
+};
+
+class LinkObserver final : public spark::EventHandler {
+	std::promise<void> up_;
+	std::atomic<std::size_t> remaining_;
+
+public:
+	explicit LinkObserver(std::size_t links) : remaining_(links) { }
+
+	void handle_message(const spark::Link&, const messaging::MessageRoot*) override { }
+
+	void handle_link_event(const spark::Link&, spark::LinkState state) override {
+		if(state == spark::LinkState::LINK_UP && --remaining_ == 0) {
+			up_.set_value();
+		}
+	}
+
+	std::future<void> links_up() {
+		return up_.get_future();
+	}
+};
+
+std::shared_ptr<flatbuffers::FlatBufferBuilder> build_lookup(const boost::uuids::uuid& uuid) {
+	auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+	auto id = fbb->CreateVector(uuid.begin(), uuid.static_size());
+	fbb->Finish(messaging::CreateMessageRoot(*fbb, messaging::Service::Account, id, 0,
+		messaging::Data::KeyLookup, messaging::account::CreateKeyLookup(*fbb, 1).Union()));
+	return fbb;
+}
+
+sc::microseconds percentile(std::vector<sc::microseconds> latencies, double percentile) {
+	const auto nth = latencies.begin() + static_cast<std::size_t>(percentile * (latencies.size() - 1));
+	std::nth_element(latencies.begin(), nth, latencies.end());
+	return *nth;
+}
+
+/*
+ * A client linked to two account servers over local sockets, one of which
+ * answers promptly while the other is slow. Rendezvous hashing gives each about
+ * half of the accounts, so without hedging half of all lookups are slow.
+ */
+class SparkHedgingTest : public ::testing::Test {
+protected:
+	boost::asio::io_service service;
+	ember::log::Logger logger;
+	spark::Service fast { "fast", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	spark::Service slow { "slow", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	spark::Service client { "client", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	StandIn fast_handler { fast, service, sc::milliseconds(0) };
+	StandIn slow_handler { slow, service, SLOW_REPLY };
+	LinkObserver observer { 2 };
+	std::unique_ptr<boost::asio::io_service::work> work;
+	std::thread worker;
+
+	std::string socket_path() {
+		return (boost::filesystem::temp_directory_path()
+			/ boost::filesystem::unique_path("ember-spark-%%%%-%%%%.sock")).string();
+	}
+
+	void SetUp() override {
+		fast.dispatcher()->register_handler(&fast_handler, messaging::Service::Account,
+		                                    spark::EventDispatcher::Mode::SERVER);
+		slow.dispatcher()->register_handler(&slow_handler, messaging::Service::Account,
+		                                    spark::EventDispatcher::Mode::SERVER);
+		client.dispatcher()->register_handler(&observer, messaging::Service::Account,
+		                                      spark::EventDispatcher::Mode::CLIENT);
+
+		const auto fast_path = socket_path(), slow_path = socket_path();
+		fast.listen_local(fast_path);
+		slow.listen_local(slow_path);
+		client.connect_local(fast_path);
+		client.connect_local(slow_path);
+
+		auto links_up = observer.links_up();
+		work = std::make_unique<boost::asio::io_service::work>(service);
+		worker = std::thread([&]() { service.run(); });
+		ASSERT_EQ(std::future_status::ready, links_up.wait_for(sc::seconds(5))) << "Links were not established";
+	}
+
+	void TearDown() override {
+		client.shutdown();
+		fast.shutdown();
+		slow.shutdown();
+		work.reset();
+		service.stop();
+		worker.join();
+		client.dispatcher()->remove_handler(&observer);
+		fast.dispatcher()->remove_handler(&fast_handler);
+		slow.dispatcher()->remove_handler(&slow_handler);
+	}
+
+	// lookups for a spread of accounts, sent a wave at a time
+	void measure(const spark::RequestPolicy& policy, std::vector<sc::microseconds>& latencies) {
+		for(std::size_t wave = 0; wave < WAVES; ++wave) {
+			std::vector<std::future<sc::microseconds>> results;
+
+			for(std::size_t i = 0; i < WAVE_SIZE; ++i) {
+				auto done = std::make_shared<std::promise<sc::microseconds>>();
+				const auto start = sc::steady_clock::now();
+				results.emplace_back(done->get_future());
+
+				auto result = client.send_hedged(messaging::Service::Account, wave * WAVE_SIZE + i, build_lookup,
+					[done, start](const spark::Link&, const boost::uuids::uuid&,
+					              boost::optional<const messaging::MessageRoot*> root) {
+						EXPECT_TRUE(root && (*root)->data_type() == messaging::Data::Response);
+						done->set_value(sc::duration_cast<sc::microseconds>(sc::steady_clock::now() - start));
+					}, policy);
+
+				ASSERT_EQ(spark::Service::Result::OK, result);
+			}
+
+			for(auto& result : results) {
+				ASSERT_EQ(std::future_status::ready, result.wait_for(sc::seconds(10))) << "Request was never answered";
+				latencies.emplace_back(result.get());
+			}
+		}
+	}
+
+	void report(const std::string& name, const std::vector<sc::microseconds>& latencies) {
+		RecordProperty(name + "_p50_us", static_cast<int>(percentile(latencies, 0.5).count()));
+		RecordProperty(name + "_p99_us", static_cast<int>(percentile(latencies, 0.99).count()));
+	}
+};
+
+} // unnamed
+
+/*
+ * Hedged lookups are measured first, so that the latency window the hedge delay
+ * is taken from isn't filled with the slow peer's answers to unhedged lookups.
+ */
+TEST_F(SparkHedgingTest, TailLatency) {
+	client.retry_budget(1.0, WAVE_SIZE); // half of all lookups need a hedge
+	const spark::RequestPolicy hedged { 2, true, false, 0.95, sc::milliseconds(20), sc::seconds(5) };
+	const spark::RequestPolicy single { 1, false, false, 0.95, sc::milliseconds(20), sc::seconds(5) };
+	std::vector<sc::microseconds> hedged_latencies, single_latencies;
+
+	measure(hedged, hedged_latencies);
+	measure(single, single_latencies);
+	report("hedged", hedged_latencies);
+	report("single", single_latencies);
+
+	ASSERT_GE(percentile(single_latencies, 0.99), SLOW_REPLY);
+	ASSERT_LT(percentile(hedged_latencies, 0.99), SLOW_REPLY / 2) << "Slow peer was not hedged around";
+}
+
+// attempts that time out before the slow peer answers are retried on the other
+TEST_F(SparkHedgingTest, RetryOnTimeout) {
+	client.retry_budget(1.0, WAVE_SIZE);
+	const spark::RequestPolicy retried { 2, false, true, 0.95, sc::milliseconds(20), sc::milliseconds(100) };
+	std::vector<sc::microseconds> latencies;
+
+	measure(retried, latencies);
+	report("retried", latencies);
+
+	ASSERT_LT(percentile(latencies, 0.99), SLOW_REPLY) << "Timed out attempts were not retried";
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/Service.h>
+#include <spark/EventHandler.h>
+#include <spark/NetworkSession.h>
+#include <logger/Logging.h>
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace spark = ember::spark;
+namespace messaging = ember::messaging;
+namespace mcast = ember::messaging::multicast;
+
+namespace {
+
+class LinkObserver final : public spark::EventHandler {
+	std::promise<void> up_;
+	std::atomic_bool signalled_ { false };
+	std::weak_ptr<spark::NetworkSession> session_;
+
+public:
+	void handle_message(const spark::Link&, const messaging::MessageRoot*) override { }
+
+	void handle_link_event(const spark::Link& link, spark::LinkState state) override {
+		if(state == spark::LinkState::LINK_UP && !signalled_.exchange(true)) {
+			session_ = link.net;
+			up_.set_value();
+		}
+	}
+
+	std::future<void> link_up() {
+		return up_.get_future();
+	}
+
+	// only valid once the link is up
+	std::shared_ptr<spark::NetworkSession> session() const {
+		return session_.lock();
+	}
+};
+
+// a server and client pair linked entirely within this process
+class SparkLocalTransportTest : public ::testing::Test {
+protected:
+	boost::asio::io_service service;
+	ember::log::Logger logger;
+	LinkObserver server_observer, client_observer;
+	spark::Service server { "server", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	spark::Service client { "client", service, "127.0.0.1", 0, &logger, ember::log::Filter(0) };
+	const std::string path = (boost::filesystem::temp_directory_path()
+		/ boost::filesystem::unique_path("ember-spark-%%%%-%%%%.sock")).string();
+
+	void SetUp() override {
+		server.dispatcher()->register_handler(&server_observer, messaging::Service::Account,
+		                                      spark::EventDispatcher::Mode::SERVER);
+		client.dispatcher()->register_handler(&client_observer, messaging::Service::Account,
+		                                      spark::EventDispatcher::Mode::CLIENT);
+		server.listen_local(path);
+	}
+
+	bool wait_for_link() {
+		auto client_up = client_observer.link_up();
+		auto server_up = server_observer.link_up();
+		std::thread worker([&]() { service.run(); });
+
+		const bool linked = client_up.wait_for(std::chrono::seconds(5)) == std::future_status::ready
+			&& server_up.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+
+		service.stop();
+		worker.join();
+		return linked;
+	}
+
+	void TearDown() override {
+		client.shutdown();
+		server.shutdown();
+		client.dispatcher()->remove_handler(&client_observer);
+		server.dispatcher()->remove_handler(&server_observer);
+	}
+};
+
+} // unnamed
+
+TEST_F(SparkLocalTransportTest, Connect) {
+	client.connect_local(path);
+	ASSERT_TRUE(wait_for_link()) << "Link over local socket was not established";
+}
+
+// the TCP details are unusable, so the link can only come up over the local socket
+TEST_F(SparkLocalTransportTest, PreferLocal) {
+	flatbuffers::FlatBufferBuilder fbb;
+	auto answer = mcast::CreateLocateAnswer(fbb, fbb.CreateString("0.0.0.0"), 1,
+		messaging::Service::Account, mcast::ServiceData::NONE, 0,
+		fbb.CreateString(boost::asio::ip::host_name()), fbb.CreateString(path));
+	fbb.Finish(answer);
+
+	client.connect(flatbuffers::GetRoot<mcast::LocateAnswer>(fbb.GetBufferPointer()));
+	ASSERT_TRUE(wait_for_link()) << "Co-located peer did not connect over local socket";
+}
+
+#ifdef __linux__
+
+// the connecting side sets up the shared memory, so falling back to the socket is a failure
+TEST_F(SparkLocalTransportTest, SharedMemory) {
+	client.shared_memory(true);
+	client.connect_local(path);
+	ASSERT_TRUE(wait_for_link()) << "Link over shared memory was not established";
+
+	auto client_session = client_observer.session();
+	auto server_session = server_observer.session();
+	ASSERT_TRUE(client_session && server_session);
+	ASSERT_TRUE(client_session->shared()) << "Connecting side fell back to the socket";
+	ASSERT_TRUE(server_session->shared()) << "Accepting side fell back to the socket";
+}
+
+#endif
+
+#endif
\ No newline at end of file
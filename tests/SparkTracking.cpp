@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/TrackingService.h>
+#include <logger/Logging.h>
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <boost/optional.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <chrono>
+#include <thread>
+
+namespace spark = ember::spark;
+namespace messaging = ember::messaging;
+namespace sc = std::chrono;
+
+namespace {
+
+const sc::milliseconds TICK(50); // as used by TrackingService
+
+// a timeout may be up to two ticks late, plus whatever the scheduler adds
+const sc::milliseconds MAX_LATENESS = TICK * 2 + sc::milliseconds(100);
+
+class SparkTrackingTest : public ::testing::Test {
+protected:
+	boost::asio::io_service service;
+	ember::log::Logger logger;
+	spark::TrackingService tracking { service, &logger, ember::log::Filter(0) };
+	boost::uuids::random_generator generate_uuid;
+	const spark::Link link { generate_uuid(), "account", {} };
+
+	/*
+	 * Registers the request just before the wheel next turns, which is when
+	 * truncating the timeout to whole ticks would expire it earliest. Returns how
+	 * long the request took to time out.
+	 */
+	sc::milliseconds time_out(sc::milliseconds timeout) {
+		service.run_one(); // the wheel has just turned
+		std::this_thread::sleep_for(TICK - sc::milliseconds(5));
+
+		boost::optional<sc::steady_clock::time_point> expired;
+		bool responded = false;
+		const auto start = sc::steady_clock::now();
+
+		tracking.register_tracked(link, generate_uuid(), [&](const spark::Link&, const boost::uuids::uuid&,
+		                                                     boost::optional<const messaging::MessageRoot*> root) {
+			expired = sc::steady_clock::now();
+			responded = static_cast<bool>(root);
+		}, timeout);
+
+		while(!expired) {
+			service.run_one();
+		}
+
+		EXPECT_FALSE(responded) << "Timed out request was given a response";
+		return sc::duration_cast<sc::milliseconds>(*expired - start);
+	}
+
+	void TearDown() override {
+		tracking.shutdown();
+		service.poll();
+	}
+};
+
+} // unnamed
+
+TEST_F(SparkTrackingTest, TimeoutNotEarly) {
+	for(auto timeout : { 10, 75, 120, 130 }) {
+		const sc::milliseconds expected(timeout);
+		const auto elapsed = time_out(expected);
+		ASSERT_GE(elapsed, expected) << "Request with a " << timeout << "ms timeout expired early";
+		ASSERT_LE(elapsed, expected + MAX_LATENESS) << "Request with a " << timeout << "ms timeout expired late";
+	}
+}
+
+TEST_F(SparkTrackingTest, TimeoutMultipleOfTick) {
+	const auto expected = TICK * 2;
+	const auto elapsed = time_out(expected);
+	ASSERT_GE(elapsed, expected) << "Request expired early";
+	ASSERT_LE(elapsed, expected + MAX_LATENESS) << "Request expired late";
+}
+
+// removed requests are dropped from the wheel without their handler being called
+TEST_F(SparkTrackingTest, RemovedNotExpired) {
+	bool called = false;
+	const auto id = generate_uuid();
+
+	tracking.register_tracked(link, id, [&](const spark::Link&, const boost::uuids::uuid&,
+	                                        boost::optional<const messaging::MessageRoot*>) {
+		called = true;
+	}, sc::milliseconds(10));
+
+	tracking.remove_tracked(id);
+	time_out(TICK * 2); // runs the wheel past the removed request's expiry
+	ASSERT_FALSE(called) << "Removed request's handler was called";
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2016 Ember
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <spark/buffers/StaticBuffer.h>
+#include <spark/buffers/ChainedBuffer.h>
+#include <spark/BinaryStream.h>
+#include <spark/Exception.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+namespace spark = ember::spark;
+
+TEST(StaticBufferTest, ReadWriteConsistency) {
+	spark::StaticBuffer<64> buffer;
+	const char text[] = "The quick brown fox jumps over the lazy dog";
+
+	buffer.write(text, sizeof(text));
+	ASSERT_EQ(sizeof(text), buffer.size()) << "Buffer size is incorrect";
+	ASSERT_EQ(64 - sizeof(text), buffer.free()) << "Free space is incorrect";
+
+	char output[sizeof(text)];
+	buffer.read(output, sizeof(text));
+	ASSERT_STREQ(text, output) << "Read produced incorrect result";
+	ASSERT_TRUE(buffer.empty()) << "Buffer should be empty";
+	ASSERT_EQ(64, buffer.free()) << "Exhausted buffer was not reset";
+}
+
+TEST(StaticBufferTest, Overflow) {
+	spark::StaticBuffer<8> buffer;
+	const std::uint32_t value = 0xBADF00D;
+
+	buffer.write(&value, sizeof(value));
+	buffer.write(&value, sizeof(value));
+	ASSERT_THROW(buffer.write(&value, 1), spark::buffer_overflow);
+	ASSERT_THROW(buffer.reserve(1), spark::buffer_overflow);
+	ASSERT_EQ(8, buffer.size()) << "Failed write modified the buffer";
+}
+
+TEST(StaticBufferTest, StreamToChain) {
+	spark::StaticBuffer<32> buffer;
+	spark::BinaryStream stream(buffer);
+	stream << std::uint8_t(0) << std::uint32_t(0xDEADBEEF) << std::string("foo");
+	buffer[0] = static_cast<char>(buffer.size());
+
+	ASSERT_EQ(9, buffer.size()) << "Buffer size is incorrect";
+	ASSERT_EQ(8, buffer.find_first_of('\0', buffer.size())) << "Incorrect terminator position";
+
+	// append the serialised data to a chain in a single copy
+	spark::ChainedBuffer<4> chain;
+	chain.write(buffer.data(), buffer.size());
+
+	spark::BinaryStream chain_stream(chain);
+	std::uint8_t size;
+	std::uint32_t value;
+	std::string text;
+
+	chain_stream >> size >> value >> text;
+	ASSERT_EQ(9, size) << "Header was not patched";
+	ASSERT_EQ(0xDEADBEEF, value) << "Deserialised value is incorrect";
+	ASSERT_EQ("foo", text) << "Deserialised string is incorrect";
+}
\ No newline at end of file